@@ -41,8 +41,15 @@ namespace GmshCommon.GH
                 "Mesh 2D entities.",
                 "Gmsh", "Meshing")
         {
+            m_options.SetNumber("Mesh.SaveAll", 0);
+            m_options.SetNumber("Mesh.SaveGroupsOfElements", -1001);
+            m_options.SetNumber("Mesh.SaveGroupsOfNodes", 2);
+            m_options.SetNumber("Mesh.ElementOrder", 1);
         }
 
+        // Meshing options, marshalled once and applied together before each Generate
+        private readonly OptionProfile m_options = new OptionProfile();
+
         protected override void RegisterInputParams(GH_Component.GH_InputParamManager pManager)
         {
             pManager.AddGenericParameter("Mesh", "M", "Mesh to remesh.", GH_ParamAccess.item);
@@ -80,66 +87,69 @@ namespace GmshCommon.GH
 
             if (mesh == null) return;
 
-            Gmsh.InitializeGmsh();
-            Gmsh.Clear();
-            Gmsh.Logger.Start();
+            using (var session = Session.Acquire())
+            using (var log = LogStream.Open())
+            {
+                session.UseModel("Mesh2D", true);
 
-            var mesh_id = -1;
+                var mesh_id = -1;
 
-            // Add mesh data
-            try
-            {
-                mesh_id = GmshCommon.GeometryExtensions.TransferMesh(mesh, create_geometry);
-            }
-            catch (Exception e)
-            {
-                string msg = Gmsh.Logger.GetLastError();
+                // Add mesh data
+                try
+                {
+                    mesh_id = GmshCommon.GeometryExtensions.TransferMesh(mesh, create_geometry);
+                }
+                catch (Exception e)
+                {
+                    string msg = Gmsh.Logger.GetLastError();
 
-                var log = Gmsh.Logger.Get();
-                foreach (string l in log)
-                    msg += String.Format("\n    {0}", log);
+                    log.Pump();
+                    LogEntry entry;
+                    while (log.TryRead(out entry))
+                        if (entry.Level >= LogLevel.Warning)
+                            msg += String.Format("\n    {0}", entry.Message);
 
-                throw new Exception(msg);
-            }
+                    throw new Exception(msg);
+                }
 
-            if (mesh_id < 0) return;
+                if (mesh_id < 0) return;
 
 
-            // Get 2D entities (the mesh we just transferred)
-             Tuple<int, int>[] surfaceTags;
-             Gmsh.Model.GetEntities(out surfaceTags, 2);
-            //Message = String.Format("{0} : {1}", mesh_id, surfaceTags[0].Item2);
+                // Get 2D entities (the mesh we just transferred)
+                 Tuple<int, int>[] surfaceTags;
+                 Gmsh.Model.GetEntities(out surfaceTags, 2);
+                //Message = String.Format("{0} : {1}", mesh_id, surfaceTags[0].Item2);
 
-            var loop = Gmsh.Model.Geo.AddSurfaceLoop(surfaceTags.Select(x => x.Item2).ToArray());
+                var loop = Gmsh.Model.Geo.AddSurfaceLoop(surfaceTags.Select(x => x.Item2).ToArray());
             
-            //var loop = Gmsh.Geo.AddSurfaceLoop(new int[] { mesh_id });
-            var vol = Gmsh.Model.Geo.AddVolume(new int[] { loop });
+                //var loop = Gmsh.Geo.AddSurfaceLoop(new int[] { mesh_id });
+                var vol = Gmsh.Model.Geo.AddVolume(new int[] { loop });
 
-            Gmsh.Model.Geo.Synchronize();
+                Gmsh.Model.Geo.Synchronize();
 
-            // Set mesh sizes
-            int element_order = 1;
-            Gmsh.Option.SetNumber("Mesh.MeshSizeMin", size_min);
-            Gmsh.Option.SetNumber("Mesh.MeshSizeMax", size_max);
+                // Set mesh sizes
+                m_options.SetNumber("Mesh.MeshSizeMin", size_min);
+                m_options.SetNumber("Mesh.MeshSizeMax", size_max);
+                session.ApplyOptions(m_options);
 
-            Gmsh.Option.SetNumber("Mesh.SaveAll", 0);
-            Gmsh.Option.SetNumber("Mesh.SaveGroupsOfElements", -1001);
-            Gmsh.Option.SetNumber("Mesh.SaveGroupsOfNodes", 2);
-            Gmsh.Option.SetNumber("Mesh.ElementOrder", element_order);
+                // Generate mesh
+                Gmsh.Model.Generate(3);
 
-            // Generate mesh
-            Gmsh.Model.Generate(3);
+                log.Pump();
+                var entries = new List<LogEntry>();
+                log.Drain(entries);
+                foreach (var entry in entries.Where(x => x.Level == LogLevel.Warning))
+                    AddRuntimeMessage(GH_RuntimeMessageLevel.Warning, entry.Message);
 
-            mesh = GmshCommon.GeometryExtensions.GetMesh();
+                mesh = GmshCommon.GeometryExtensions.GetMesh();
 
-            mesh.Compact();
-            List<Mesh> meshes = new List<Mesh>();
+                mesh.Compact();
+                List<Mesh> meshes = new List<Mesh>();
 
-            meshes.Add(mesh);
+                meshes.Add(mesh);
 
-            DA.SetDataList(0, meshes);
-
-            Gmsh.FinalizeGmsh();
+                DA.SetDataList(0, meshes);
+            }
         }
 
         protected override System.Drawing.Bitmap Icon
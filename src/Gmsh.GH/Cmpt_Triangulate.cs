@@ -62,36 +62,37 @@ namespace GmshCommon.GH
 
             if (points.Count < 1) return;
 
-            Gmsh.InitializeGmsh();
-
-            var ptsFlat2d = new double[points.Count * 2];
-
-            for (int i = 0; i < points.Count; ++i)
+            using (var session = Session.Acquire())
             {
-                var pt = points[i];
-                ptsFlat2d[i * 2 + 0] = pt.X;
-                ptsFlat2d[i * 2 + 1] = pt.Y;
-            }
+                session.UseModel("Triangulate", true);
 
-            var tris = Gmsh.Model.Mesh.Triangulate(ptsFlat2d);
-            var nTris = tris.Length / 3;
+                var ptsFlat2d = new double[points.Count * 2];
 
-            var mesh2d = new Mesh();
-            mesh2d.Vertices.AddVertices(points);
+                for (int i = 0; i < points.Count; ++i)
+                {
+                    var pt = points[i];
+                    ptsFlat2d[i * 2 + 0] = pt.X;
+                    ptsFlat2d[i * 2 + 1] = pt.Y;
+                }
 
+                var tris = Gmsh.Model.Mesh.Triangulate(ptsFlat2d);
+                var nTris = tris.Length / 3;
+
+                var mesh2d = new Mesh();
+                mesh2d.Vertices.AddVertices(points);
 
-            for (int i = 0; i < nTris; ++i)
-            {
-                int a = (int)tris[i * 3 + 0] - 1,
-                  b = (int)tris[i * 3 + 1] - 1,
-                  c = (int)tris[i * 3 + 2] - 1;
-                mesh2d.Faces.AddFace(a, b, c);
-            }
 
+                for (int i = 0; i < nTris; ++i)
+                {
+                    int a = (int)tris[i * 3 + 0] - 1,
+                      b = (int)tris[i * 3 + 1] - 1,
+                      c = (int)tris[i * 3 + 2] - 1;
+                    mesh2d.Faces.AddFace(a, b, c);
+                }
 
-            DA.SetData("Mesh", mesh2d);
 
-            Gmsh.FinalizeGmsh();
+                DA.SetData("Mesh", mesh2d);
+            }
         }
 
         protected override System.Drawing.Bitmap Icon
@@ -9,7 +9,7 @@ namespace GmshCommon.GH
 {
     public static class Tetra
     {
-        public static Mesh GetTetrahedralizedShell(List<Point3d> points, double maxEdgeLength = 100, double volumeThreshold = 1e-5, double maxAnisotropy=1e5, double angleToleranceFacetOverlap=0.3)
+        public static Mesh GetTetrahedralizedShell(List<Point3d> points, double maxEdgeLength = 100, double volumeThreshold = 1e-5, double maxAnisotropy=1e5, double angleToleranceFacetOverlap=0.3, double maxGamma = 0)
         {
             if (points == null || points.Count < 4) return null;
 
@@ -25,115 +25,38 @@ namespace GmshCommon.GH
             }
 
             // Do the gee mesh
-            Gmsh.InitializeGmsh();
-
-            Gmsh.Option.SetNumber("Mesh.AngleToleranceFacetOverlap", angleToleranceFacetOverlap);
-            Gmsh.Option.SetNumber("Mesh.AnisoMax", maxAnisotropy);
-
-            var tetra = Gmsh.Model.Mesh.Tetrahedralize(ptsFlat3d).Select(x => (int)x - 1).ToArray();
-
-
-            // Filter tetras for quality, edge length, volume
-            var tetraList = new List<int[]>();
-
-            for (int i = 0; i < tetra.Length; i += 4)
+            using (var session = Session.Acquire())
+            using (var options = new OptionProfile())
             {
-                double volume, gamma;
-
-                GetTetraQuality(
-                    points[tetra[i + 0]],
-                    points[tetra[i + 1]],
-                    points[tetra[i + 2]],
-                    points[tetra[i + 3]],
-                    out volume, out gamma);
+                session.UseModel("TetrahedralizedShell", true);
 
-                var maxEdge = GetMaxEdgeLength(
-                    points[tetra[i + 0]],
-                    points[tetra[i + 1]],
-                    points[tetra[i + 2]],
-                    points[tetra[i + 3]]);
+                // Restored when the session handle is disposed, so later jobs start from the same options
+                options.SetNumber("Mesh.AngleToleranceFacetOverlap", angleToleranceFacetOverlap);
+                options.SetNumber("Mesh.AnisoMax", maxAnisotropy);
+                session.ApplyOptions(options);
 
+                // Filter tetras for edge length, volume and (optionally) gamma, then keep the
+                // faces that belong to a single tetra. Both happen natively.
+                int[] tetra, faces;
+                Gmsh.Model.Mesh.TetrahedralizeShell(ptsFlat3d, maxEdgeLength, volumeThreshold, maxGamma, out tetra, out faces);
 
-                if (gamma > 40)
-                {
-                    //TO DO: Figure out appropriate tetra quality measure
+                var mesh3d = new Mesh();
+                mesh3d.Vertices.AddVertices(points);
 
-                    //continue;
-                }
-                if (maxEdge > maxEdgeLength)
-                {
-                    continue;
-                }
-                if (volume < volumeThreshold)
+                for (int i = 0; i < faces.Length; i += 3)
                 {
-                    continue;
+                    mesh3d.Faces.AddFace(faces[i], faces[i + 1], faces[i + 2]);
                 }
 
-                tetraList.Add(new int[]{
-                    tetra[i + 0],
-                    tetra[i + 1],
-                    tetra[i + 2],
-                    tetra[i + 3]});
-            }
-
-            var nTetra = tetraList.Count;
-
-            var comparer = new CompareIntArray();
-
-            var cellSet = new HashBucket<int[]>(comparer);
+                mesh3d.Compact();
 
-            foreach (var tet in tetraList)
-            {
-                var c0 = new int[] { tet[0], tet[1], tet[2] };
-                Array.Sort(c0);
-                cellSet.Add(c0);
-
-                var c1 = new int[] { tet[1], tet[2], tet[3] };
-                Array.Sort(c1);
-                cellSet.Add(c1);
-
-                var c2 = new int[] { tet[2], tet[3], tet[0] };
-                Array.Sort(c2);
-                cellSet.Add(c2);
-
-                var c3 = new int[] { tet[3], tet[0], tet[1] };
-                Array.Sort(c3);
-                cellSet.Add(c3);
-            }
-
-            var faces = cellSet.GetUnique();
-            /*
-            faces.Sort((f0, f1) =>
-            {
-                int xdiff = f0[0].CompareTo(f1[0]);
-                if (xdiff != 0) return xdiff;
-                else
-                {
-                    int ydiff = f0[1].CompareTo(f1[1]);
-                    if (ydiff != 0) return ydiff;
-                    else
-                        return f0[2].CompareTo(f1[2]);
-                }
-            });
-            */
+                mesh3d.UnifyNormals();
+                mesh3d.Normals.ComputeNormals();
 
-            var mesh3d = new Mesh();
-            mesh3d.Vertices.AddVertices(points);
+                mesh3d.RebuildNormals();
 
-            foreach (var face in faces)
-            {
-                mesh3d.Faces.AddFace(face[0], face[1], face[2]);
+                return mesh3d;
             }
-
-            mesh3d.Compact();
-
-            mesh3d.UnifyNormals();
-            mesh3d.Normals.ComputeNormals();
-
-            mesh3d.RebuildNormals();
-            Gmsh.FinalizeGmsh();
-
-            return mesh3d;
         }
 
 
@@ -0,0 +1,86 @@
+using System.Diagnostics;
+using GmshCommon;
+
+// Compares reading a binary MSH 4.1 file through gmsh (Open + GetNodes + GetElements)
+// with MshFile, which maps the file and copies nodes and elements out directly.
+//
+//   GmshBench [file.msh] [repetitions]
+//
+// Without a file, a meshed box is generated and written to a temporary file first.
+
+string path = args.Length > 0 ? args[0] : "";
+int repetitions = Math.Max(1, args.Length > 1 ? int.Parse(args[1]) : 5);
+
+Gmsh.InitializeGmsh();
+Gmsh.Option.SetNumber("General.Terminal", 0);
+
+bool generated = string.IsNullOrEmpty(path);
+if (generated)
+{
+    path = Path.Combine(Path.GetTempPath(), "GmshBench.msh");
+
+    Gmsh.Model.Add("bench");
+    Gmsh.Model.OCC.AddBox(0, 0, 0, 1, 1, 1);
+    Gmsh.Model.OCC.Synchronize();
+    Gmsh.Option.SetNumber("Mesh.MeshSizeMax", 0.02);
+    Gmsh.Model.Generate(3);
+
+    Gmsh.Option.SetNumber("Mesh.Binary", 1);
+    Gmsh.Option.SetNumber("Mesh.MshFileVersion", 4.1);
+    Gmsh.Write(path);
+}
+
+Console.WriteLine($"File: {path} ({new FileInfo(path).Length / (1024.0 * 1024.0):F1} MB)");
+
+long checkGmsh = 0, checkMsh = 0;
+
+double gmshMs = Measure(() =>
+{
+    Gmsh.Clear();
+    Gmsh.Open(path);
+
+    Gmsh.Model.Mesh.GetNodes(out IntPtr[] nodeTags, out double[] coords, -1, -1, false, false);
+    Gmsh.Model.Mesh.GetElements(out int[] types, out IntPtr[][] elementTags, out IntPtr[][] elementNodes, -1, -1);
+
+    checkGmsh = nodeTags.LongLength;
+    foreach (var tags in elementTags) checkGmsh += tags?.LongLength ?? 0;
+});
+
+double mshMs = Measure(() =>
+{
+    using (var file = new MshFile(path))
+    {
+        file.GetNodes(out IntPtr[] nodeTags, out double[] coords);
+        ElementBlocks blocks = file.GetElementBlocks();
+
+        checkMsh = nodeTags.LongLength + blocks.ElementTags.LongLength;
+    }
+});
+
+Console.WriteLine($"Open + GetNodes + GetElements: {gmshMs,10:F1} ms");
+Console.WriteLine($"MshFile:                       {mshMs,10:F1} ms  ({gmshMs / mshMs:F1}x)");
+
+if (checkGmsh != checkMsh)
+    Console.WriteLine($"Warning: node + element counts differ ({checkGmsh} vs {checkMsh}).");
+
+if (generated)
+    File.Delete(path);
+
+Gmsh.FinalizeGmsh();
+
+// Median wall time over the repetitions, after one warm-up run.
+double Measure(Action action)
+{
+    action();
+
+    var times = new double[repetitions];
+    for (int i = 0; i < repetitions; ++i)
+    {
+        var watch = Stopwatch.StartNew();
+        action();
+        times[i] = watch.Elapsed.TotalMilliseconds;
+    }
+
+    Array.Sort(times);
+    return times[repetitions / 2];
+}
@@ -0,0 +1,198 @@
+// Compiled as native code.
+#include "BooleanScheduler.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			int FindRoot(std::vector<int>& parent, int i)
+			{
+				while (parent[i] != i)
+				{
+					parent[i] = parent[parent[i]];
+					i = parent[i];
+				}
+				return i;
+			}
+
+			void Run(BooleanKind kind, const gmsh::vectorpair& objectDimTags, const gmsh::vectorpair& toolDimTags,
+				gmsh::vectorpair& outDimTags, std::vector<gmsh::vectorpair>& outDimTagsMap,
+				int tag, bool removeObject, bool removeTool)
+			{
+				switch (kind)
+				{
+				case BooleanKind::Fragment:
+					gmsh::model::occ::fragment(objectDimTags, toolDimTags, outDimTags, outDimTagsMap, tag, removeObject, removeTool);
+					break;
+				case BooleanKind::Intersect:
+					gmsh::model::occ::intersect(objectDimTags, toolDimTags, outDimTags, outDimTagsMap, tag, removeObject, removeTool);
+					break;
+				case BooleanKind::Cut:
+					gmsh::model::occ::cut(objectDimTags, toolDimTags, outDimTags, outDimTagsMap, tag, removeObject, removeTool);
+					break;
+				}
+			}
+		}
+
+		int ClusterBoxes(const std::vector<double>& boxes, double margin, std::vector<int>& cluster)
+		{
+			const int n = static_cast<int>(boxes.size() / 6);
+
+			std::vector<int> parent(n);
+			std::iota(parent.begin(), parent.end(), 0);
+
+			std::vector<int> order(n);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&boxes](int a, int b) { return boxes[6 * a] < boxes[6 * b]; });
+
+			// Boxes whose x range is still open at the current xmin
+			std::vector<int> active;
+			for (int i = 0; i < n; ++i)
+			{
+				const double* box = &boxes[6 * order[i]];
+
+				size_t kept = 0;
+				for (size_t j = 0; j < active.size(); ++j)
+					if (boxes[6 * active[j] + 3] + margin >= box[0])
+						active[kept++] = active[j];
+				active.resize(kept);
+
+				for (size_t j = 0; j < active.size(); ++j)
+				{
+					const double* other = &boxes[6 * active[j]];
+					if (other[1] <= box[4] + margin && box[1] <= other[4] + margin &&
+						other[2] <= box[5] + margin && box[2] <= other[5] + margin)
+						parent[FindRoot(parent, active[j])] = FindRoot(parent, order[i]);
+				}
+
+				active.push_back(order[i]);
+			}
+
+			std::vector<int> id(n, -1);
+			int numClusters = 0;
+
+			cluster.resize(n);
+			for (int i = 0; i < n; ++i)
+			{
+				int root = FindRoot(parent, i);
+				if (id[root] < 0) id[root] = numClusters++;
+				cluster[i] = id[root];
+			}
+
+			return numClusters;
+		}
+
+		void RunClustered(BooleanKind kind, const gmsh::vectorpair& objectDimTags, const gmsh::vectorpair& toolDimTags,
+			gmsh::vectorpair& outDimTags, std::vector<gmsh::vectorpair>& outDimTagsMap,
+			int tag, bool removeObject, bool removeTool)
+		{
+			const size_t numObjects = objectDimTags.size();
+
+			gmsh::vectorpair all(objectDimTags);
+			all.insert(all.end(), toolDimTags.begin(), toolDimTags.end());
+
+			std::vector<double> boxes(6 * all.size());
+			for (size_t i = 0; i < all.size(); ++i)
+			{
+				double* box = &boxes[6 * i];
+				gmsh::model::occ::getBoundingBox(all[i].first, all[i].second, box[0], box[1], box[2], box[3], box[4], box[5]);
+			}
+
+			double toleranceBoolean, tolerance;
+			gmsh::option::getNumber("Geometry.ToleranceBoolean", toleranceBoolean);
+			gmsh::option::getNumber("Geometry.Tolerance", tolerance);
+
+			std::vector<int> cluster;
+			int numClusters = ClusterBoxes(boxes, std::max(toleranceBoolean, tolerance), cluster);
+
+			if (numClusters <= 1)
+			{
+				Run(kind, objectDimTags, toolDimTags, outDimTags, outDimTagsMap, tag, removeObject, removeTool);
+				return;
+			}
+
+			std::vector<std::vector<size_t>> members(numClusters);
+			for (size_t i = 0; i < all.size(); ++i)
+				members[cluster[i]].push_back(i);
+
+			outDimTags.clear();
+			outDimTagsMap.assign(all.size(), gmsh::vectorpair());
+
+			gmsh::vectorpair objects, tools, clusterOut, unused;
+			std::vector<gmsh::vectorpair> clusterMap;
+			std::vector<size_t> index;
+
+			for (int c = 0; c < numClusters; ++c)
+			{
+				const std::vector<size_t>& group = members[c];
+
+				objects.clear();
+				tools.clear();
+				index.clear();
+				for (size_t i = 0; i < group.size(); ++i)
+					if (group[i] < numObjects) { objects.push_back(all[group[i]]); index.push_back(group[i]); }
+				for (size_t i = 0; i < group.size(); ++i)
+					if (group[i] >= numObjects) { tools.push_back(all[group[i]]); index.push_back(group[i]); }
+
+				bool clusterRemoveObject = removeObject, clusterRemoveTool = removeTool;
+
+				if (objects.empty() || tools.empty())
+				{
+					if (kind == BooleanKind::Fragment && group.size() > 1)
+					{
+						// Fragment intersects all of its arguments with each other, so a
+						// cluster of only objects or only tools is split in two
+						bool fromObjects = tools.empty();
+						if (fromObjects)
+						{
+							tools.push_back(objects.back());
+							objects.pop_back();
+							clusterRemoveTool = removeObject;
+						}
+						else
+						{
+							objects.push_back(tools.front());
+							tools.erase(tools.begin());
+							clusterRemoveObject = removeTool;
+						}
+					}
+					else
+					{
+						// Nothing to combine with: fragment and cut leave the entity as it
+						// is, intersect leaves nothing of it
+						for (size_t i = 0; i < group.size(); ++i)
+						{
+							const std::pair<int, int>& dimTag = all[group[i]];
+							bool isObject = group[i] < numObjects;
+
+							if (kind == BooleanKind::Fragment || (kind == BooleanKind::Cut && isObject))
+							{
+								outDimTags.push_back(dimTag);
+								outDimTagsMap[group[i]].push_back(dimTag);
+							}
+							else if (isObject ? removeObject : removeTool)
+								unused.push_back(dimTag);
+						}
+						continue;
+					}
+				}
+
+				clusterOut.clear();
+				clusterMap.clear();
+				Run(kind, objects, tools, clusterOut, clusterMap, -1, clusterRemoveObject, clusterRemoveTool);
+
+				outDimTags.insert(outDimTags.end(), clusterOut.begin(), clusterOut.end());
+				for (size_t i = 0; i < clusterMap.size() && i < index.size(); ++i)
+					outDimTagsMap[index[i]] = clusterMap[i];
+			}
+
+			if (!unused.empty())
+				gmsh::model::occ::remove(unused, true);
+		}
+	}
+}
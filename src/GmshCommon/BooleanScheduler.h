@@ -0,0 +1,28 @@
+#pragma once
+
+#include "gmsh.h"
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		enum class BooleanKind { Fragment, Intersect, Cut };
+
+		// Groups boxes (xmin, ymin, zmin, xmax, ymax, zmax each) that overlap within
+		// 'margin', directly or through a chain of other boxes, by sweep and prune
+		// along x and union-find. cluster[i] is the cluster of box i; clusters are
+		// numbered in order of their first box. Returns the number of clusters.
+		int ClusterBoxes(const std::vector<double>& boxes, double margin, std::vector<int>& cluster);
+
+		// Runs the OCC boolean 'kind' once per cluster of objects and tools whose
+		// bounding boxes overlap, instead of once over everything, so OCC only tests
+		// pairs that can touch. outDimTags and outDimTagsMap are merged back into
+		// what a single call would return: the map has one entry per object, then
+		// one per tool, in input order. 'tag' is only honoured if everything ends up
+		// in one cluster.
+		void RunClustered(BooleanKind kind, const gmsh::vectorpair& objectDimTags, const gmsh::vectorpair& toolDimTags,
+			gmsh::vectorpair& outDimTags, std::vector<gmsh::vectorpair>& outDimTagsMap,
+			int tag, bool removeObject, bool removeTool);
+	}
+}
@@ -0,0 +1,218 @@
+// Compiled as native code.
+#include "BrepBuilder.h"
+
+#include "gmsh.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			void CheckOffsets(const std::vector<int>& offsets, size_t count, size_t size, const char* name)
+			{
+				if (offsets.size() != count + 1 || offsets[0] != 0 || static_cast<size_t>(offsets[count]) != size)
+					throw std::invalid_argument(std::string("Bad ") + name + " offsets.");
+
+				for (size_t i = 0; i < count; ++i)
+					if (offsets[i + 1] < offsets[i])
+						throw std::invalid_argument(std::string("Bad ") + name + " offsets.");
+			}
+
+			void CheckIndices(const std::vector<int>& indices, size_t count, const char* name)
+			{
+				for (size_t i = 0; i < indices.size(); ++i)
+					if (indices[i] < 0 || static_cast<size_t>(indices[i]) >= count)
+						throw std::invalid_argument(std::string(name) + " index out of range.");
+			}
+
+			void Validate(const BrepArrays& brep)
+			{
+				size_t numCurves = brep.curveDegrees.size();
+				CheckOffsets(brep.curvePointOffsets, numCurves, brep.curveWeights.size(), "curve point");
+				if (brep.curvePoints.size() != 3 * brep.curveWeights.size())
+					throw std::invalid_argument("Curve points and weights do not match.");
+				CheckOffsets(brep.curveKnotOffsets, numCurves, brep.curveKnots.size(), "curve knot");
+				if (brep.curveMultiplicities.size() != brep.curveKnots.size())
+					throw std::invalid_argument("Curve knots and multiplicities do not match.");
+
+				if (brep.vertexPoints.size() % 3 != 0)
+					throw std::invalid_argument("Vertex points must be xyz triplets.");
+				if (!brep.curveVertices.empty() && brep.curveVertices.size() != 2 * numCurves)
+					throw std::invalid_argument("Curves need a start and an end vertex each.");
+				int numVertices = static_cast<int>(brep.vertexPoints.size() / 3);
+				for (size_t i = 0; i < brep.curveVertices.size(); ++i)
+					if (brep.curveVertices[i] < -1 || brep.curveVertices[i] >= numVertices)
+						throw std::invalid_argument("Vertex index out of range.");
+
+				size_t numSurfaces = brep.surfacePointsU.size();
+				if (brep.surfaceDegrees.size() != 2 * numSurfaces)
+					throw std::invalid_argument("Surfaces need a u and a v degree each.");
+				CheckOffsets(brep.surfacePointOffsets, numSurfaces, brep.surfaceWeights.size(), "surface point");
+				if (brep.surfacePoints.size() != 3 * brep.surfaceWeights.size())
+					throw std::invalid_argument("Surface points and weights do not match.");
+				CheckOffsets(brep.surfaceKnotOffsets, 2 * numSurfaces, brep.surfaceKnots.size(), "surface knot");
+				if (brep.surfaceMultiplicities.size() != brep.surfaceKnots.size())
+					throw std::invalid_argument("Surface knots and multiplicities do not match.");
+
+				if (brep.loopOffsets.empty())
+					throw std::invalid_argument("Bad loop offsets.");
+				size_t numLoops = brep.loopOffsets.size() - 1;
+				CheckOffsets(brep.loopOffsets, numLoops, brep.loopCurves.size(), "loop");
+				CheckIndices(brep.loopCurves, numCurves, "Curve");
+
+				size_t numFaces = brep.faceSurfaces.size();
+				CheckOffsets(brep.faceLoopOffsets, numFaces, brep.faceLoops.size(), "face loop");
+				CheckIndices(brep.faceSurfaces, numSurfaces, "Surface");
+				CheckIndices(brep.faceLoops, numLoops, "Loop");
+			}
+
+			// Adds one OCC point per control point and records it for removal. The
+			// first and last control points are replaced by 'first' and 'last' if
+			// those are existing point tags (>= 0).
+			void AddControlPoints(const std::vector<double>& points, int begin, int end, int first, int last, std::vector<int>& pointTags, gmsh::vectorpair& construction)
+			{
+				pointTags.resize(end - begin);
+				for (int i = begin; i < end; ++i)
+				{
+					if (i == begin && first >= 0)
+						pointTags[0] = first;
+					else if (i == end - 1 && last >= 0)
+						pointTags[i - begin] = last;
+					else
+					{
+						pointTags[i - begin] = gmsh::model::occ::addPoint(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+						construction.push_back(std::make_pair(0, pointTags[i - begin]));
+					}
+				}
+			}
+
+			// The shared point of vertex 'v', added on first use; -1 for no vertex.
+			int VertexTag(const BrepArrays& brep, int v, std::vector<int>& vertexTags, gmsh::vectorpair& construction)
+			{
+				if (v < 0) return -1;
+
+				if (vertexTags[v] < 0)
+				{
+					vertexTags[v] = gmsh::model::occ::addPoint(brep.vertexPoints[3 * v], brep.vertexPoints[3 * v + 1], brep.vertexPoints[3 * v + 2]);
+					construction.push_back(std::make_pair(0, vertexTags[v]));
+				}
+
+				return vertexTags[v];
+			}
+		}
+
+		void BuildBrep(const BrepArrays& brep, bool solid, bool heal, double tolerance, BrepResult& result)
+		{
+			Validate(brep);
+
+			gmsh::vectorpair points, curvesAndSurfaces;
+			std::vector<int> pointTags, wireTags, loopTags;
+			std::vector<int> multiplicities, multiplicitiesV;
+			std::vector<double> weights, knots, knotsV;
+
+			// Curves are only built once a loop uses them
+			std::vector<int> curveTags(brep.curveDegrees.size(), -1);
+			std::vector<int> surfaceTags(brep.surfacePointsU.size(), -1);
+			std::vector<int> vertexTags(brep.vertexPoints.size() / 3, -1);
+
+			result.faceTags.resize(brep.faceSurfaces.size());
+			result.volumeTag = -1;
+
+			for (size_t f = 0; f < brep.faceSurfaces.size(); ++f)
+			{
+				int s = brep.faceSurfaces[f];
+				if (surfaceTags[s] < 0)
+				{
+					int p0 = brep.surfacePointOffsets[s], p1 = brep.surfacePointOffsets[s + 1];
+					int u0 = brep.surfaceKnotOffsets[2 * s], v0 = brep.surfaceKnotOffsets[2 * s + 1], v1 = brep.surfaceKnotOffsets[2 * s + 2];
+
+					AddControlPoints(brep.surfacePoints, p0, p1, -1, -1, pointTags, points);
+					weights.assign(brep.surfaceWeights.begin() + p0, brep.surfaceWeights.begin() + p1);
+					knots.assign(brep.surfaceKnots.begin() + u0, brep.surfaceKnots.begin() + v0);
+					knotsV.assign(brep.surfaceKnots.begin() + v0, brep.surfaceKnots.begin() + v1);
+					multiplicities.assign(brep.surfaceMultiplicities.begin() + u0, brep.surfaceMultiplicities.begin() + v0);
+					multiplicitiesV.assign(brep.surfaceMultiplicities.begin() + v0, brep.surfaceMultiplicities.begin() + v1);
+
+					surfaceTags[s] = gmsh::model::occ::addBSplineSurface(pointTags, brep.surfacePointsU[s], -1,
+						brep.surfaceDegrees[2 * s], brep.surfaceDegrees[2 * s + 1], weights,
+						knots, knotsV, multiplicities, multiplicitiesV);
+					curvesAndSurfaces.push_back(std::make_pair(2, surfaceTags[s]));
+				}
+
+				wireTags.clear();
+				for (int l = brep.faceLoopOffsets[f]; l < brep.faceLoopOffsets[f + 1]; ++l)
+				{
+					int loop = brep.faceLoops[l];
+
+					loopTags.clear();
+					for (int i = brep.loopOffsets[loop]; i < brep.loopOffsets[loop + 1]; ++i)
+					{
+						int c = brep.loopCurves[i];
+						if (curveTags[c] < 0)
+						{
+							int p0 = brep.curvePointOffsets[c], p1 = brep.curvePointOffsets[c + 1];
+							int k0 = brep.curveKnotOffsets[c], k1 = brep.curveKnotOffsets[c + 1];
+
+							// A closed curve keeps its own end points: gmsh reads a curve that
+							// starts and ends on the same point as periodic.
+							int first = -1, last = -1;
+							if (!brep.curveVertices.empty() && brep.curveVertices[2 * c] != brep.curveVertices[2 * c + 1] && p1 - p0 > 1)
+							{
+								first = VertexTag(brep, brep.curveVertices[2 * c], vertexTags, points);
+								last = VertexTag(brep, brep.curveVertices[2 * c + 1], vertexTags, points);
+							}
+
+							AddControlPoints(brep.curvePoints, p0, p1, first, last, pointTags, points);
+							weights.assign(brep.curveWeights.begin() + p0, brep.curveWeights.begin() + p1);
+							knots.assign(brep.curveKnots.begin() + k0, brep.curveKnots.begin() + k1);
+							multiplicities.assign(brep.curveMultiplicities.begin() + k0, brep.curveMultiplicities.begin() + k1);
+
+							curveTags[c] = gmsh::model::occ::addBSpline(pointTags, -1, brep.curveDegrees[c], weights, knots, multiplicities);
+							curvesAndSurfaces.push_back(std::make_pair(1, curveTags[c]));
+						}
+
+						loopTags.push_back(curveTags[c]);
+					}
+
+					wireTags.push_back(gmsh::model::occ::addWire(loopTags, -1, true));
+				}
+
+				result.faceTags[f] = gmsh::model::occ::addTrimmedSurface(surfaceTags[s], wireTags, brep.wire3D);
+			}
+
+			// The faces hold on to the shapes they were built from, so the construction
+			// entities only need their tags released. Points go first, as curves take
+			// their end points with them.
+			gmsh::model::occ::remove(points, false);
+			gmsh::model::occ::remove(curvesAndSurfaces, true);
+
+			gmsh::vectorpair healDimTags;
+			if (solid)
+			{
+				int shell = gmsh::model::occ::addSurfaceLoop(result.faceTags);
+				result.volumeTag = gmsh::model::occ::addVolume(std::vector<int>(1, shell));
+				healDimTags.push_back(std::make_pair(3, result.volumeTag));
+			}
+			else
+			{
+				for (size_t f = 0; f < result.faceTags.size(); ++f)
+					healDimTags.push_back(std::make_pair(2, result.faceTags[f]));
+			}
+
+			if (heal)
+			{
+				// healShapes reports every shape in the model, so the tags are assumed
+				// to stay as they are. Faces built from shared 3D curves are already
+				// sewn, and sewing is by far the most expensive fix.
+				gmsh::vectorpair outDimTags;
+				gmsh::model::occ::healShapes(outDimTags, healDimTags, tolerance, true, true, true, !brep.wire3D, true);
+			}
+
+			gmsh::model::occ::synchronize();
+		}
+	}
+}
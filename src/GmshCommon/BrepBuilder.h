@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// A boundary representation as flat arrays. Curves and surfaces are rational
+		// B-splines: control points as xyz triplets with one weight each, and distinct
+		// knots with their multiplicities. Every *Offsets array holds n + 1 running
+		// offsets, so item i covers [offsets[i], offsets[i + 1]).
+		struct BrepArrays
+		{
+			// Curves, either in model space or in the parameter space of the face
+			// whose loops use them (see wire3D)
+			std::vector<int> curveDegrees;
+			std::vector<int> curvePointOffsets;
+			std::vector<double> curvePoints, curveWeights;
+			std::vector<int> curveKnotOffsets;
+			std::vector<double> curveKnots;
+			std::vector<int> curveMultiplicities;
+
+			// Optional shared end points: vertices as xyz triplets, and for each curve
+			// the indices of its start and end vertex (-1 for none). A curve that has
+			// them uses the vertex in place of its first or last control point, so
+			// curves meeting at a vertex share it, and a curve used by several loops
+			// is built once and shared by their faces.
+			std::vector<double> vertexPoints;
+			std::vector<int> curveVertices;
+
+			// Surfaces, with control points u-fastest. Degrees and knot runs come in
+			// (u, v) pairs, so there are 2 * n degrees and 2 * n + 1 knot offsets.
+			std::vector<int> surfaceDegrees;
+			std::vector<int> surfacePointsU;
+			std::vector<int> surfacePointOffsets;
+			std::vector<double> surfacePoints, surfaceWeights;
+			std::vector<int> surfaceKnotOffsets;
+			std::vector<double> surfaceKnots;
+			std::vector<int> surfaceMultiplicities;
+
+			// Loops are runs of curve indices; faces are a surface index and a run of
+			// loop indices, the outer loop first.
+			std::vector<int> loopOffsets, loopCurves;
+			std::vector<int> faceSurfaces;
+			std::vector<int> faceLoopOffsets, faceLoops;
+
+			bool wire3D;
+		};
+
+		struct BrepResult
+		{
+			std::vector<int> faceTags;
+			int volumeTag;
+		};
+
+		// Builds 'brep' in the OCC kernel without synchronizing in between: control
+		// points, curves, wires, surfaces and trimmed faces are all added first, the
+		// construction entities are removed again, and the model is synchronized once
+		// at the end. If 'solid', the faces are closed into a volume. With wire3D the
+		// faces share the curves their loops have in common, so healing skips sewing.
+		// Throws std::invalid_argument if the arrays are inconsistent.
+		void BuildBrep(const BrepArrays& brep, bool solid, bool heal, double tolerance, BrepResult& result);
+	}
+}
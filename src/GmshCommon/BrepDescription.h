@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "BrepBuilder.h"
+#include "Scratch.h"
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// A whole Brep in flat arrays, for Gmsh.Model.OCC.AddBrep. Curves and surfaces
+	/// are rational B-splines: control points as xyz triplets with one weight each,
+	/// and distinct knots with their multiplicities. Every *Offsets array holds
+	/// n + 1 running offsets, so item i covers [Offsets[i], Offsets[i + 1]).
+	/// </summary>
+	public ref class BrepDescription
+	{
+	public:
+		BrepDescription()
+		{
+			Wire3D = false;
+		}
+
+		// Curves used by the loops, in model space if Wire3D, otherwise in the
+		// parameter space of the face whose loops use them (z is ignored).
+		// Point offsets count control points, not coordinates.
+		property array<int>^ CurveDegrees;
+		property array<int>^ CurvePointOffsets;
+		property array<double>^ CurvePoints;
+		property array<double>^ CurveWeights;
+		property array<int>^ CurveKnotOffsets;
+		property array<double>^ CurveKnots;
+		property array<int>^ CurveMultiplicities;
+
+		// Optional shared end points: vertices as xyz triplets, and a start and an
+		// end vertex index per curve (-1 for none). With these and Wire3D, edges
+		// meeting at a vertex share it and faces share the curves their loops have
+		// in common, so the result comes out sewn. Closed curves keep their own end
+		// points.
+		property array<double>^ VertexPoints;
+		property array<int>^ CurveVertices;
+
+		// Untrimmed surfaces, with control points u-fastest and SurfacePointsU per
+		// row. Degrees and knot runs come in (u, v) pairs: surface i has degrees
+		// [2i], [2i + 1] and its u knots start at SurfaceKnotOffsets[2i], its v
+		// knots at SurfaceKnotOffsets[2i + 1].
+		property array<int>^ SurfaceDegrees;
+		property array<int>^ SurfacePointsU;
+		property array<int>^ SurfacePointOffsets;
+		property array<double>^ SurfacePoints;
+		property array<double>^ SurfaceWeights;
+		property array<int>^ SurfaceKnotOffsets;
+		property array<double>^ SurfaceKnots;
+		property array<int>^ SurfaceMultiplicities;
+
+		// Loops are runs of curve indices in LoopCurves; faces are a surface index
+		// and a run of loop indices in FaceLoops, the outer loop first.
+		property array<int>^ LoopOffsets;
+		property array<int>^ LoopCurves;
+		property array<int>^ FaceSurfaces;
+		property array<int>^ FaceLoopOffsets;
+		property array<int>^ FaceLoops;
+
+		property bool Wire3D;
+
+	internal:
+		void ToNative(Native::BrepArrays& brep)
+		{
+			Native::CopyIn(CurveDegrees, brep.curveDegrees);
+			Native::CopyIn(CurvePointOffsets, brep.curvePointOffsets);
+			Native::CopyIn(CurvePoints, brep.curvePoints);
+			Native::CopyIn(CurveWeights, brep.curveWeights);
+			Native::CopyIn(CurveKnotOffsets, brep.curveKnotOffsets);
+			Native::CopyIn(CurveKnots, brep.curveKnots);
+			Native::CopyIn(CurveMultiplicities, brep.curveMultiplicities);
+			Native::CopyIn(VertexPoints, brep.vertexPoints);
+			Native::CopyIn(CurveVertices, brep.curveVertices);
+
+			Native::CopyIn(SurfaceDegrees, brep.surfaceDegrees);
+			Native::CopyIn(SurfacePointsU, brep.surfacePointsU);
+			Native::CopyIn(SurfacePointOffsets, brep.surfacePointOffsets);
+			Native::CopyIn(SurfacePoints, brep.surfacePoints);
+			Native::CopyIn(SurfaceWeights, brep.surfaceWeights);
+			Native::CopyIn(SurfaceKnotOffsets, brep.surfaceKnotOffsets);
+			Native::CopyIn(SurfaceKnots, brep.surfaceKnots);
+			Native::CopyIn(SurfaceMultiplicities, brep.surfaceMultiplicities);
+
+			Native::CopyIn(LoopOffsets, brep.loopOffsets);
+			Native::CopyIn(LoopCurves, brep.loopCurves);
+			Native::CopyIn(FaceSurfaces, brep.faceSurfaces);
+			Native::CopyIn(FaceLoopOffsets, brep.faceLoopOffsets);
+			Native::CopyIn(FaceLoops, brep.faceLoops);
+
+			brep.wire3D = Wire3D;
+		}
+	};
+}
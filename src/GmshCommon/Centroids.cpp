@@ -0,0 +1,38 @@
+// Compiled as native code so that the worker threads never enter the CLR.
+#include "Centroids.h"
+#include "Parallel.h"
+
+#include "gmsh.h"
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Below this many elements per task the thread hand-off costs more than it saves.
+		static const size_t MinElementsPerTask = 4096;
+
+		void GetBarycenters(int elementType, int tag, bool fast, bool primary, std::vector<double>& barycenters, size_t numTasks)
+		{
+			barycenters.clear();
+			gmsh::model::mesh::preallocateBarycenters(elementType, barycenters, tag);
+
+			if (barycenters.size() < 1) return;
+
+			size_t numElements = barycenters.size() / 3;
+			if (numTasks < 1) numTasks = DefaultNumTasks();
+
+			size_t maxTasks = (numElements + MinElementsPerTask - 1) / MinElementsPerTask;
+			if (numTasks > maxTasks) numTasks = maxTasks;
+
+			ParallelFor(numTasks, [&](size_t task)
+				{
+					gmsh::model::mesh::getBarycenters(elementType, tag, fast, primary, barycenters, task, numTasks);
+				});
+		}
+
+		void GetCentroids(int elementType, int tag, std::vector<double>& centroids, size_t numTasks)
+		{
+			GetBarycenters(elementType, tag, false, false, centroids, numTasks);
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Barycenters of every element of 'elementType' classified on entity 'tag'
+		// (all entities if tag < 0), as xyz triplets. The output is preallocated once
+		// and split into 'numTasks' slices through getBarycenters' task partitioning,
+		// each filled on the shared thread pool. numTasks < 1 uses all cores.
+		void GetBarycenters(int elementType, int tag, bool fast, bool primary, std::vector<double>& barycenters, size_t numTasks);
+
+		// Centroids (mean of all element nodes), computed as above.
+		void GetCentroids(int elementType, int tag, std::vector<double>& centroids, size_t numTasks);
+	}
+}
@@ -0,0 +1,123 @@
+// Compiled as native code.
+#include "ContentHash.h"
+
+#include <cstring>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			const uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+			const uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+			const uint64_t Prime3 = 0x165667B19E3779F9ULL;
+
+			inline uint64_t Rotl(uint64_t x, int r)
+			{
+				return (x << r) | (x >> (64 - r));
+			}
+
+			inline uint64_t Round(uint64_t lane, uint64_t word)
+			{
+				return Rotl(lane + word * Prime2, 31) * Prime1;
+			}
+
+			inline uint64_t Load(const unsigned char* ptr)
+			{
+				uint64_t word;
+				std::memcpy(&word, ptr, sizeof(word));
+				return word;
+			}
+
+			inline uint64_t Mix(uint64_t x)
+			{
+				x ^= x >> 33;
+				x *= 0xFF51AFD7ED558CCDULL;
+				x ^= x >> 33;
+				x *= 0xC4CEB9FE1A85EC53ULL;
+				x ^= x >> 33;
+				return x;
+			}
+		}
+
+		void ContentHash::Reset()
+		{
+			m_a = Prime1 + Prime2;
+			m_b = Prime3;
+			m_length = 0;
+			m_numPending = 0;
+		}
+
+		void ContentHash::Update(const void* data, size_t bytes)
+		{
+			const unsigned char* ptr = static_cast<const unsigned char*>(data);
+			m_length += bytes;
+
+			if (m_numPending > 0)
+			{
+				size_t count = bytes < 16 - m_numPending ? bytes : 16 - m_numPending;
+				std::memcpy(m_pending + m_numPending, ptr, count);
+				m_numPending += count;
+				ptr += count;
+				bytes -= count;
+
+				if (m_numPending < 16)
+					return;
+
+				m_a = Round(m_a, Load(m_pending));
+				m_b = Round(m_b, Load(m_pending + 8));
+				m_numPending = 0;
+			}
+
+			uint64_t a = m_a, b = m_b;
+			for (; bytes >= 16; ptr += 16, bytes -= 16)
+			{
+				a = Round(a, Load(ptr));
+				b = Round(b, Load(ptr + 8));
+			}
+			m_a = a;
+			m_b = b;
+
+			std::memcpy(m_pending, ptr, bytes);
+			m_numPending = bytes;
+		}
+
+		std::string ContentHash::Digest() const
+		{
+			unsigned char tail[16] = {};
+			std::memcpy(tail, m_pending, m_numPending);
+
+			uint64_t a = m_a, b = m_b;
+			if (m_numPending > 0)
+			{
+				a = Round(a, Load(tail));
+				b = Round(b, Load(tail + 8));
+			}
+
+			a ^= m_length;
+			b ^= Rotl(m_length, 32) * Prime3;
+			a += b;
+			b += a;
+			a = Mix(a);
+			b = Mix(b);
+			a += b;
+			b += a;
+
+			static const char digits[] = "0123456789abcdef";
+			std::string out(32, '0');
+			for (int i = 0; i < 16; ++i)
+			{
+				out[15 - i] = digits[(a >> (4 * i)) & 0xF];
+				out[31 - i] = digits[(b >> (4 * i)) & 0xF];
+			}
+			return out;
+		}
+
+		ContentHash& InputHash()
+		{
+			static ContentHash hash;
+			return hash;
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Streaming 128-bit hash for cache keys. Not cryptographic; the input is
+		// consumed in 16-byte blocks by two independent multiply-rotate lanes.
+		class ContentHash
+		{
+		public:
+			ContentHash() { Reset(); }
+
+			void Reset();
+			void Update(const void* data, size_t bytes);
+
+			// Hex string of the 128-bit digest of everything added so far.
+			std::string Digest() const;
+
+			template<typename T>
+			void Add(const T& value)
+			{
+				static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed directly.");
+				Update(&value, sizeof(T));
+			}
+
+			// Sequences are length-prefixed, so ("ab", "c") and ("a", "bc") differ.
+			void Add(const char* value)
+			{
+				Add(std::string(value));
+			}
+
+			void Add(const std::string& value)
+			{
+				Add(value.size());
+				Update(value.data(), value.size());
+			}
+
+			template<typename T>
+			void Add(const std::vector<T>& values)
+			{
+				static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed directly.");
+				Add(values.size());
+				Update(values.data(), values.size() * sizeof(T));
+			}
+
+			template<typename T, typename U>
+			void Add(const std::vector<std::pair<T, U>>& values)
+			{
+				Add(values.size());
+				for (const std::pair<T, U>& v : values)
+				{
+					Add(v.first);
+					Add(v.second);
+				}
+			}
+
+			template<typename T>
+			void Add(const std::vector<std::vector<T>>& values)
+			{
+				Add(values.size());
+				for (const std::vector<T>& v : values)
+					Add(v);
+			}
+
+		private:
+			uint64_t m_a, m_b, m_length;
+			unsigned char m_pending[16];
+			size_t m_numPending;
+		};
+
+		// Hash of the model inputs passed through the wrapper since the last reset.
+		ContentHash& InputHash();
+
+		inline void Record() {}
+
+		// Adds each argument to InputHash(), in order.
+		template<typename T, typename... Rest>
+		void Record(const T& first, const Rest&... rest)
+		{
+			InputHash().Add(first);
+			Record(rest...);
+		}
+	}
+}
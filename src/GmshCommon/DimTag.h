@@ -0,0 +1,92 @@
+#pragma once
+
+#include "gmsh.h"
+#include <vector>
+#include <utility>
+#include <cstring>
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Blittable (dim, tag) pair. Arrays of DimTag share their memory layout with
+	/// gmsh::vectorpair, so they convert with a single block copy.
+	/// </summary>
+	[System::Runtime::InteropServices::StructLayout(System::Runtime::InteropServices::LayoutKind::Sequential)]
+	public value struct DimTag : System::IEquatable<DimTag>
+	{
+		int Dim;
+		int Tag;
+
+		DimTag(int dim, int tag) : Dim(dim), Tag(tag) {}
+
+		virtual bool Equals(DimTag other)
+		{
+			return Dim == other.Dim && Tag == other.Tag;
+		}
+
+		virtual bool Equals(System::Object^ obj) override
+		{
+			return obj != nullptr && obj->GetType() == DimTag::typeid && Equals(safe_cast<DimTag>(obj));
+		}
+
+		virtual int GetHashCode() override
+		{
+			return (Dim * 397) ^ Tag;
+		}
+
+		virtual System::String^ ToString() override
+		{
+			return System::String::Format("({0}, {1})", Dim, Tag);
+		}
+	};
+
+	namespace Native {
+
+		static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int), "gmsh::vectorpair must be tightly packed.");
+
+		inline void ToVectorPair(array<DimTag>^ dimTags, gmsh::vectorpair& out)
+		{
+			out.resize(dimTags->Length);
+			if (dimTags->Length < 1) return;
+
+			pin_ptr<DimTag> pinned = &dimTags[0];
+			std::memcpy(out.data(), pinned, dimTags->Length * 2 * sizeof(int));
+		}
+
+		inline array<DimTag>^ ToDimTags(const gmsh::vectorpair& dimTags)
+		{
+			array<DimTag>^ out = gcnew array<DimTag>(static_cast<int>(dimTags.size()));
+			if (dimTags.size() < 1) return out;
+
+			pin_ptr<DimTag> pinned = &out[0];
+			std::memcpy(pinned, dimTags.data(), dimTags.size() * 2 * sizeof(int));
+
+			return out;
+		}
+
+		// Flattens a nested map into one DimTag array; entry i spans [offsets[i], offsets[i + 1]).
+		inline void ToDimTagsMap(const std::vector<gmsh::vectorpair>& dimTagsMap, array<DimTag>^% flat, array<int>^% offsets)
+		{
+			offsets = gcnew array<int>(static_cast<int>(dimTagsMap.size()) + 1);
+
+			size_t count = 0;
+			for (int i = 0; i < dimTagsMap.size(); ++i)
+			{
+				count += dimTagsMap[i].size();
+				offsets[i + 1] = static_cast<int>(count);
+			}
+
+			flat = gcnew array<DimTag>(static_cast<int>(count));
+			if (count < 1) return;
+
+			pin_ptr<DimTag> pinned = &flat[0];
+			char* ptr = reinterpret_cast<char*>(static_cast<DimTag*>(pinned));
+			for (int i = 0; i < dimTagsMap.size(); ++i)
+			{
+				size_t bytes = dimTagsMap[i].size() * 2 * sizeof(int);
+				std::memcpy(ptr, dimTagsMap[i].data(), bytes);
+				ptr += bytes;
+			}
+		}
+	}
+}
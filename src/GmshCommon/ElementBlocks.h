@@ -0,0 +1,92 @@
+#pragma once
+
+using System::IntPtr;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Mesh elements grouped by element type, stored in two flat tag arrays.
+	/// Block i covers ElementTags[ElementOffsets[i] .. ElementOffsets[i + 1]) and
+	/// NodeTags[NodeOffsets[i] .. NodeOffsets[i + 1]).
+	/// </summary>
+	public ref class ElementBlocks
+	{
+	public:
+		ElementBlocks(array<int>^ elementTypes, array<int>^ elementCounts, array<int>^ nodesPerElement, array<IntPtr>^ elementTags, array<IntPtr>^ nodeTags)
+		{
+			if (elementTypes == nullptr || elementCounts == nullptr || nodesPerElement == nullptr || elementTags == nullptr || nodeTags == nullptr)
+				throw gcnew System::ArgumentNullException();
+
+			int numBlocks = elementTypes->Length;
+			if (elementCounts->Length != numBlocks || nodesPerElement->Length != numBlocks)
+				throw gcnew System::ArgumentException("Element type, count and nodes-per-element tables must have the same length.");
+
+			m_elementTypes = elementTypes;
+			m_elementCounts = elementCounts;
+			m_nodesPerElement = nodesPerElement;
+			m_elementTags = elementTags;
+			m_nodeTags = nodeTags;
+
+			m_elementOffsets = gcnew array<int>(numBlocks + 1);
+			m_nodeOffsets = gcnew array<int>(numBlocks + 1);
+
+			for (int i = 0; i < numBlocks; ++i)
+			{
+				m_elementOffsets[i + 1] = m_elementOffsets[i] + elementCounts[i];
+				m_nodeOffsets[i + 1] = m_nodeOffsets[i] + elementCounts[i] * nodesPerElement[i];
+			}
+
+			if (m_elementOffsets[numBlocks] != elementTags->Length || m_nodeOffsets[numBlocks] != nodeTags->Length)
+				throw gcnew System::ArgumentException("Tag arrays do not match the element counts.");
+		}
+
+		property int NumBlocks
+		{
+			int get() { return m_elementTypes->Length; }
+		}
+
+		property array<int>^ ElementTypes
+		{
+			array<int>^ get() { return m_elementTypes; }
+		}
+
+		property array<int>^ ElementCounts
+		{
+			array<int>^ get() { return m_elementCounts; }
+		}
+
+		property array<int>^ NodesPerElement
+		{
+			array<int>^ get() { return m_nodesPerElement; }
+		}
+
+		property array<int>^ ElementOffsets
+		{
+			array<int>^ get() { return m_elementOffsets; }
+		}
+
+		property array<int>^ NodeOffsets
+		{
+			array<int>^ get() { return m_nodeOffsets; }
+		}
+
+		property array<IntPtr>^ ElementTags
+		{
+			array<IntPtr>^ get() { return m_elementTags; }
+		}
+
+		property array<IntPtr>^ NodeTags
+		{
+			array<IntPtr>^ get() { return m_nodeTags; }
+		}
+
+	private:
+		array<int>^ m_elementTypes;
+		array<int>^ m_elementCounts;
+		array<int>^ m_nodesPerElement;
+		array<int>^ m_elementOffsets;
+		array<int>^ m_nodeOffsets;
+		array<IntPtr>^ m_elementTags;
+		array<IntPtr>^ m_nodeTags;
+	};
+}
@@ -0,0 +1,418 @@
+// Compiled as native code.
+#include "ElementBvh.h"
+#include "Parallel.h"
+#include "QualityKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <immintrin.h>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			const size_t PointsPerTask = 4096;
+			const double NotInside = -std::numeric_limits<double>::infinity();
+
+			// Gmsh reference coordinates of the 8-node hexahedron
+			const double HexCorners[8][3] = {
+				{ -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+				{ -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } };
+
+			inline void Cross(const double* a, const double* b, double* c)
+			{
+				c[0] = a[1] * b[2] - a[2] * b[1];
+				c[1] = a[2] * b[0] - a[0] * b[2];
+				c[2] = a[0] * b[1] - a[1] * b[0];
+			}
+
+			inline double Dot(const double* a, const double* b)
+			{
+				return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+			}
+
+			inline double Length(const double* a)
+			{
+				return std::sqrt(Dot(a, a));
+			}
+
+			// Local coordinates of 'point' in the four simplices of a packet, and for each
+			// the smallest barycentric weight (off-plane distance folded in for triangles).
+			void EvaluatePacket(const double* packet, const double* point, bool triangles, double* q, double* u, double* v, double* w)
+			{
+				for (int k = 0; k < 4; ++k)
+				{
+					double dx = point[0] - packet[9 * 4 + k];
+					double dy = point[1] - packet[10 * 4 + k];
+					double dz = point[2] - packet[11 * 4 + k];
+
+					u[k] = packet[0 * 4 + k] * dx + packet[1 * 4 + k] * dy + packet[2 * 4 + k] * dz;
+					v[k] = packet[3 * 4 + k] * dx + packet[4 * 4 + k] * dy + packet[5 * 4 + k] * dz;
+					w[k] = packet[6 * 4 + k] * dx + packet[7 * 4 + k] * dy + packet[8 * 4 + k] * dz;
+
+					q[k] = triangles ?
+						std::min(std::min(u[k], v[k]), std::min(-std::abs(w[k]), 1 - u[k] - v[k])) :
+						std::min(std::min(u[k], v[k]), std::min(w[k], 1 - u[k] - v[k] - w[k]));
+				}
+			}
+
+#if GMSHCOMMON_AVX2
+			void EvaluatePacketAvx2(const double* packet, const double* point, bool triangles, double* q, double* u, double* v, double* w)
+			{
+				__m256d dx = _mm256_sub_pd(_mm256_set1_pd(point[0]), _mm256_loadu_pd(packet + 9 * 4));
+				__m256d dy = _mm256_sub_pd(_mm256_set1_pd(point[1]), _mm256_loadu_pd(packet + 10 * 4));
+				__m256d dz = _mm256_sub_pd(_mm256_set1_pd(point[2]), _mm256_loadu_pd(packet + 11 * 4));
+
+				__m256d lu = _mm256_add_pd(_mm256_add_pd(
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 0 * 4), dx),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 1 * 4), dy)),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 2 * 4), dz));
+				__m256d lv = _mm256_add_pd(_mm256_add_pd(
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 3 * 4), dx),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 4 * 4), dy)),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 5 * 4), dz));
+				__m256d lw = _mm256_add_pd(_mm256_add_pd(
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 6 * 4), dx),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 7 * 4), dy)),
+					_mm256_mul_pd(_mm256_loadu_pd(packet + 8 * 4), dz));
+
+				__m256d rest = _mm256_sub_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), lu), lv);
+				__m256d third = lw;
+				if (triangles)
+					third = _mm256_or_pd(lw, _mm256_set1_pd(-0.0));	// -|w|
+				else
+					rest = _mm256_sub_pd(rest, lw);
+
+				_mm256_storeu_pd(q, _mm256_min_pd(_mm256_min_pd(lu, lv), _mm256_min_pd(third, rest)));
+				_mm256_storeu_pd(u, lu);
+				_mm256_storeu_pd(v, lv);
+				_mm256_storeu_pd(w, lw);
+			}
+#endif
+
+			typedef void (*PacketFunction)(const double*, const double*, bool, double*, double*, double*, double*);
+
+			PacketFunction GetPacketFunction()
+			{
+#if GMSHCOMMON_AVX2
+				if (HasAvx2()) return EvaluatePacketAvx2;
+#endif
+				return EvaluatePacket;
+			}
+		}
+
+		ElementBvh::ElementBvh(const double* coords, size_t numNodes, const int* connectivity, size_t numElements, int nodesPerElement, double tolerance)
+			: m_coords(coords, coords + numNodes * 3), m_connectivity(connectivity, connectivity + numElements * nodesPerElement),
+			m_numElements(numElements), m_nodesPerElement(nodesPerElement), m_tolerance(std::max(0.0, tolerance))
+		{
+			if (nodesPerElement != 3 && nodesPerElement != 4 && nodesPerElement != 8)
+				throw std::invalid_argument("Only 3-node triangles, 4-node tetrahedra and 8-node hexahedra are supported.");
+
+			for (size_t i = 0; i < m_connectivity.size(); ++i)
+				if (m_connectivity[i] < 0 || static_cast<size_t>(m_connectivity[i]) >= numNodes)
+					throw std::out_of_range("Node index out of range.");
+
+			if (numElements < 1) return;
+
+			// Element boxes, padded by the tolerance, and their centres
+			std::vector<double> boxes(numElements * 6), centroids(numElements * 3);
+			for (size_t i = 0; i < numElements; ++i)
+			{
+				double* box = boxes.data() + i * 6;
+				for (int k = 0; k < 3; ++k)
+				{
+					box[k] = std::numeric_limits<double>::max();
+					box[k + 3] = std::numeric_limits<double>::lowest();
+				}
+
+				for (int j = 0; j < nodesPerElement; ++j)
+				{
+					const double* p = m_coords.data() + m_connectivity[i * nodesPerElement + j] * 3;
+					for (int k = 0; k < 3; ++k)
+					{
+						box[k] = std::min(box[k], p[k]);
+						box[k + 3] = std::max(box[k + 3], p[k]);
+					}
+				}
+
+				double pad = m_tolerance * std::max(box[3] - box[0], std::max(box[4] - box[1], box[5] - box[2]));
+				for (int k = 0; k < 3; ++k)
+				{
+					box[k] -= pad;
+					box[k + 3] += pad;
+					centroids[i * 3 + k] = (box[k] + box[k + 3]) * 0.5;
+				}
+			}
+
+			std::vector<int> items(numElements);
+			for (size_t i = 0; i < numElements; ++i)
+				items[i] = static_cast<int>(i);
+
+			m_nodes.reserve(2 * (numElements / LeafSize + 1));
+			m_nodes.push_back(Node());
+			Build(0, items.data(), items.data() + numElements, boxes, centroids);
+		}
+
+		void ElementBvh::Build(int node, int* begin, int* end, const std::vector<double>& boxes, const std::vector<double>& centroids)
+		{
+			Node& n = m_nodes[node];
+			double cmin[3], cmax[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				n.min[k] = cmin[k] = std::numeric_limits<double>::max();
+				n.max[k] = cmax[k] = std::numeric_limits<double>::lowest();
+			}
+
+			for (int* it = begin; it != end; ++it)
+			{
+				const double* box = boxes.data() + *it * 6;
+				const double* c = centroids.data() + *it * 3;
+				for (int k = 0; k < 3; ++k)
+				{
+					n.min[k] = std::min(n.min[k], box[k]);
+					n.max[k] = std::max(n.max[k], box[k + 3]);
+					cmin[k] = std::min(cmin[k], c[k]);
+					cmax[k] = std::max(cmax[k], c[k]);
+				}
+			}
+
+			int count = static_cast<int>(end - begin);
+			if (count <= LeafSize)
+			{
+				int slot = static_cast<int>(m_slots.size());
+				m_slots.resize(slot + LeafSize, -1);
+				m_affine.resize(m_affine.size() + LeafSize * 12, 0.0);
+
+				n.first = slot;
+				n.count = count;
+				for (int i = 0; i < count; ++i)
+					Prepare(slot + i, begin[i]);
+				return;
+			}
+
+			// Median split along the widest extent of the element centres
+			int axis = 0;
+			for (int k = 1; k < 3; ++k)
+				if (cmax[k] - cmin[k] > cmax[axis] - cmin[axis]) axis = k;
+
+			int* mid = begin + count / 2;
+			std::nth_element(begin, mid, end, [&](int a, int b) { return centroids[a * 3 + axis] < centroids[b * 3 + axis]; });
+
+			int left = static_cast<int>(m_nodes.size());
+			n.first = left;
+			n.count = 0;
+
+			// 'n' is invalidated here
+			m_nodes.push_back(Node());
+			m_nodes.push_back(Node());
+
+			Build(left, begin, mid, boxes, centroids);
+			Build(left + 1, mid, end, boxes, centroids);
+		}
+
+		void ElementBvh::Prepare(int slot, int element)
+		{
+			m_slots[slot] = element;
+			if (m_nodesPerElement == 8) return;
+
+			const int* nodes = m_connectivity.data() + element * m_nodesPerElement;
+			const double* a = m_coords.data() + nodes[0] * 3;
+
+			double e[3][3];
+			for (int k = 0; k < 3; ++k)
+			{
+				e[0][k] = m_coords[nodes[1] * 3 + k] - a[k];
+				e[1][k] = m_coords[nodes[2] * 3 + k] - a[k];
+			}
+
+			if (m_nodesPerElement == 4)
+			{
+				for (int k = 0; k < 3; ++k)
+					e[2][k] = m_coords[nodes[3] * 3 + k] - a[k];
+			}
+			else
+			{
+				// Unit normal scaled to the size of the triangle, so that w measures the
+				// distance from its plane relative to that size
+				Cross(e[0], e[1], e[2]);
+				double area2 = Length(e[2]);
+				double scale = area2 > 0 ? std::sqrt(area2) / area2 : 0.0;
+				for (int k = 0; k < 3; ++k)
+					e[2][k] *= scale;
+			}
+
+			// Rows of the inverse of the matrix with columns e0, e1, e2
+			double r[3][3];
+			Cross(e[1], e[2], r[0]);
+			Cross(e[2], e[0], r[1]);
+			Cross(e[0], e[1], r[2]);
+
+			double det = Dot(e[0], r[0]);
+			double scale = Length(e[0]) * Length(e[1]) * Length(e[2]);
+			if (!(std::abs(det) > 1e-12 * scale))
+			{
+				m_slots[slot] = -1;
+				return;
+			}
+
+			double* packet = m_affine.data() + (slot / LeafSize) * LeafSize * 12;
+			int lane = slot % LeafSize;
+			for (int i = 0; i < 3; ++i)
+				for (int k = 0; k < 3; ++k)
+					packet[(i * 3 + k) * LeafSize + lane] = r[i][k] / det;
+
+			for (int k = 0; k < 3; ++k)
+				packet[(9 + k) * LeafSize + lane] = a[k];
+		}
+
+		double ElementBvh::TestHexahedron(int element, const double* point, double* local) const
+		{
+			const int* nodes = m_connectivity.data() + element * 8;
+			double xi[3] = { 0, 0, 0 };
+
+			// Newton iterations on the trilinear map
+			for (int iteration = 0; iteration < 20; ++iteration)
+			{
+				double r[3] = { -point[0], -point[1], -point[2] };
+				double j[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+
+				for (int n = 0; n < 8; ++n)
+				{
+					const double* c = HexCorners[n];
+					double f[3] = { 1 + c[0] * xi[0], 1 + c[1] * xi[1], 1 + c[2] * xi[2] };
+					double shape = f[0] * f[1] * f[2] * 0.125;
+					double d[3] = { c[0] * f[1] * f[2] * 0.125, f[0] * c[1] * f[2] * 0.125, f[0] * f[1] * c[2] * 0.125 };
+
+					const double* x = m_coords.data() + nodes[n] * 3;
+					for (int k = 0; k < 3; ++k)
+					{
+						r[k] += shape * x[k];
+						for (int m = 0; m < 3; ++m)
+							j[k][m] += d[m] * x[k];
+					}
+				}
+
+				double cols[3][3] = { { j[0][0], j[1][0], j[2][0] }, { j[0][1], j[1][1], j[2][1] }, { j[0][2], j[1][2], j[2][2] } };
+				double inv[3][3];
+				Cross(cols[1], cols[2], inv[0]);
+				Cross(cols[2], cols[0], inv[1]);
+				Cross(cols[0], cols[1], inv[2]);
+
+				double det = Dot(cols[0], inv[0]);
+				if (det == 0 || !std::isfinite(det)) return NotInside;
+
+				double step = 0;
+				for (int k = 0; k < 3; ++k)
+				{
+					double delta = Dot(inv[k], r) / det;
+					xi[k] -= delta;
+					step = std::max(step, std::abs(delta));
+				}
+
+				if (std::abs(xi[0]) > 10 || std::abs(xi[1]) > 10 || std::abs(xi[2]) > 10) return NotInside;
+				if (step < 1e-12) break;
+			}
+
+			for (int k = 0; k < 3; ++k)
+				local[k] = xi[k];
+
+			return 1 - std::max(std::abs(xi[0]), std::max(std::abs(xi[1]), std::abs(xi[2])));
+		}
+
+		int ElementBvh::Locate(const double* point, double* local) const
+		{
+			local[0] = local[1] = local[2] = 0;
+			if (m_nodes.empty()) return -1;
+
+			static const PacketFunction evaluate = GetPacketFunction();
+			bool triangles = m_nodesPerElement == 3;
+
+			int best = -1;
+			double bestQuality = -m_tolerance;
+
+			int stack[128];
+			int top = 0;
+			stack[top++] = 0;
+
+			while (top > 0)
+			{
+				const Node& n = m_nodes[stack[--top]];
+				if (point[0] < n.min[0] || point[0] > n.max[0] ||
+					point[1] < n.min[1] || point[1] > n.max[1] ||
+					point[2] < n.min[2] || point[2] > n.max[2])
+					continue;
+
+				if (n.count == 0)
+				{
+					stack[top++] = n.first + 1;
+					stack[top++] = n.first;
+					continue;
+				}
+
+				if (m_nodesPerElement == 8)
+				{
+					for (int i = 0; i < n.count; ++i)
+					{
+						double xi[3];
+						double quality = TestHexahedron(m_slots[n.first + i], point, xi);
+						if (quality < bestQuality || (best >= 0 && quality == bestQuality)) continue;
+
+						best = m_slots[n.first + i];
+						bestQuality = quality;
+						local[0] = xi[0];
+						local[1] = xi[1];
+						local[2] = xi[2];
+					}
+				}
+				else
+				{
+					double q[4], u[4], v[4], w[4];
+					evaluate(m_affine.data() + (n.first / LeafSize) * LeafSize * 12, point, triangles, q, u, v, w);
+
+					for (int i = 0; i < n.count; ++i)
+					{
+						if (m_slots[n.first + i] < 0) continue;
+						if (!(q[i] >= bestQuality) || (best >= 0 && q[i] == bestQuality)) continue;
+
+						best = m_slots[n.first + i];
+						bestQuality = q[i];
+						local[0] = u[i];
+						local[1] = v[i];
+						local[2] = triangles ? 0.0 : w[i];
+					}
+				}
+
+				// Strictly inside (or on a shared face): no other element can do better
+				if (best >= 0 && bestQuality >= 0) break;
+			}
+
+			return best;
+		}
+
+		size_t ElementBvh::Locate(const double* points, size_t numPoints, int* elements, double* local) const
+		{
+			size_t numTasks = (numPoints + PointsPerTask - 1) / PointsPerTask;
+			std::vector<size_t> found(numTasks, 0);
+
+			ParallelFor(numTasks, [&](size_t task)
+				{
+					size_t begin = task * PointsPerTask, end = std::min(numPoints, begin + PointsPerTask);
+					for (size_t i = begin; i < end; ++i)
+					{
+						elements[i] = Locate(points + i * 3, local + i * 3);
+						if (elements[i] >= 0) ++found[task];
+					}
+				});
+
+			size_t total = 0;
+			for (size_t i = 0; i < numTasks; ++i)
+				total += found[i];
+
+			return total;
+		}
+	}
+}
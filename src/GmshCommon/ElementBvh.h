@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Bounding volume hierarchy over the elements of a linear mesh, answering
+		// "which element contains this point" together with the local coordinates of
+		// the point in that element:
+		//   3-node triangles:   (u, v, 0), barycentric weights of nodes 1 and 2
+		//   4-node tetrahedra:  (u, v, w), barycentric weights of nodes 1, 2 and 3
+		//   8-node hexahedra:   (u, v, w) in [-1, 1], Gmsh node ordering
+		// Element i uses connectivity[i * nodesPerElement ...]; node indices are zero-based
+		// into 'coords' (xyz triplets). The inputs are copied.
+		class ElementBvh
+		{
+		public:
+			// 'tolerance' is relative to the element size: points that far outside an
+			// element (or off the plane of a triangle) still count as inside it.
+			ElementBvh(const double* coords, size_t numNodes, const int* connectivity, size_t numElements, int nodesPerElement, double tolerance);
+
+			size_t NumElements() const { return m_numElements; }
+			int NodesPerElement() const { return m_nodesPerElement; }
+			const std::vector<double>& Coords() const { return m_coords; }
+			const std::vector<int>& Connectivity() const { return m_connectivity; }
+
+			// Returns the containing element, or -1, and writes three local coordinates.
+			int Locate(const double* point, double* local) const;
+
+			// Locates 'numPoints' points (xyz triplets) on the native thread pool and
+			// returns how many were found.
+			size_t Locate(const double* points, size_t numPoints, int* elements, double* local) const;
+
+		private:
+			struct Node
+			{
+				double min[3], max[3];
+				int first;	// leaf: first slot; inner: index of the left child (the right one follows)
+				int count;	// 0 for inner nodes
+			};
+
+			void Build(int node, int* begin, int* end, const std::vector<double>& boxes, const std::vector<double>& centroids);
+			void Prepare(int slot, int element);
+			double TestHexahedron(int element, const double* point, double* local) const;
+
+			static const int LeafSize = 4;
+
+			std::vector<double> m_coords;
+			std::vector<int> m_connectivity;
+			size_t m_numElements;
+			int m_nodesPerElement;
+			double m_tolerance;
+
+			std::vector<Node> m_nodes;
+			std::vector<int> m_slots;		// element in each leaf slot, -1 for padding and degenerate elements
+
+			// Affine maps from world to local coordinates for simplices, in packets of
+			// LeafSize slots: value j of slot s is at ((s / 4) * 12 + j) * 4 + s % 4.
+			// Values 0-8 are the row-major matrix, 9-11 the origin.
+			std::vector<double> m_affine;
+		};
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "gmsh.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// A run of at most chunkSize elements of one type on one entity. The pointers
+		// refer to the cursor's buffers and stay valid until the next call to Next.
+		struct ElementChunkView
+		{
+			int dim, tag, elementType;
+			size_t nodesPerElement, offset, count;
+			const size_t* elementTags;
+			const size_t* nodeTags;
+		};
+
+		// Walks the elements of the current model entity by entity and type by type,
+		// handing them out in chunks. Only one (entity, type) block is held at a time,
+		// and its buffers are reused, so memory is bounded by the largest such block
+		// rather than by the whole mesh.
+		class ElementCursor
+		{
+		public:
+			// All entities of dimension 'dim' (all dimensions if dim < 0), or only entity
+			// (dim, tag) if tag >= 0, which needs dim >= 0.
+			ElementCursor(int dim, int tag, size_t chunkSize)
+				: m_chunkSize(std::max<size_t>(chunkSize, 1)), m_entity(0), m_type(0), m_offset(0)
+			{
+				if (tag >= 0 && dim < 0)
+					throw std::invalid_argument("A single entity needs its dimension.");
+
+				if (tag >= 0)
+					m_entities.push_back(std::make_pair(dim, tag));
+				else
+					gmsh::model::getEntities(m_entities, dim);
+			}
+
+			bool Next(ElementChunkView& view)
+			{
+				while (m_offset >= m_elementTags.size())
+				{
+					if (!Advance()) return false;
+				}
+
+				const std::pair<int, int>& entity = m_entities[m_entity];
+				size_t npe = m_nodeTags.size() / m_elementTags.size();
+
+				view.dim = entity.first;
+				view.tag = entity.second;
+				view.elementType = m_types[m_type];
+				view.nodesPerElement = npe;
+				view.offset = m_offset;
+				view.count = std::min(m_chunkSize, m_elementTags.size() - m_offset);
+				view.elementTags = m_elementTags.data() + m_offset;
+				view.nodeTags = m_nodeTags.data() + m_offset * npe;
+
+				m_offset += view.count;
+				return true;
+			}
+
+		private:
+			// Loads the next non-empty (entity, type) block. Returns false when done.
+			bool Advance()
+			{
+				if (m_entity >= m_entities.size()) return false;
+
+				if (m_types.empty() || m_type + 1 >= m_types.size())
+				{
+					// First call, or the current entity is exhausted
+					if (!m_types.empty()) ++m_entity;
+					m_types.clear();
+					m_type = 0;
+
+					while (m_entity < m_entities.size())
+					{
+						gmsh::model::mesh::getElementTypes(m_types, m_entities[m_entity].first, m_entities[m_entity].second);
+						if (!m_types.empty()) break;
+						++m_entity;
+					}
+
+					if (m_entity >= m_entities.size()) return false;
+				}
+				else
+					++m_type;
+
+				m_elementTags.clear();
+				m_nodeTags.clear();
+				gmsh::model::mesh::getElementsByType(m_types[m_type], m_elementTags, m_nodeTags, m_entities[m_entity].second);
+				m_offset = 0;
+				return true;
+			}
+
+			size_t m_chunkSize;
+			gmsh::vectorpair m_entities;
+			std::vector<int> m_types;
+			size_t m_entity, m_type, m_offset;
+			std::vector<size_t> m_elementTags, m_nodeTags;
+		};
+	}
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "ElementCursor.h"
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Up to ChunkSize elements of one type on one entity. Only the first Count
+	/// entries of ElementTags (and Count * NodesPerElement of NodeTags) are valid;
+	/// the arrays are reused, so a chunk is only valid until the enumerator moves on.
+	/// </summary>
+	public ref class ElementChunk
+	{
+	public:
+		property int Dim { int get() { return m_dim; } }
+		property int Tag { int get() { return m_tag; } }
+		property int ElementType { int get() { return m_elementType; } }
+		property int NodesPerElement { int get() { return m_nodesPerElement; } }
+
+		// Index of the first element of this chunk within its (entity, type) block.
+		property long long Offset { long long get() { return m_offset; } }
+		property int Count { int get() { return m_count; } }
+
+		property array<IntPtr>^ ElementTags { array<IntPtr>^ get() { return m_elementTags; } }
+		property array<IntPtr>^ NodeTags { array<IntPtr>^ get() { return m_nodeTags; } }
+
+	internal:
+		ElementChunk(int chunkSize)
+		{
+			m_elementTags = gcnew array<IntPtr>(chunkSize);
+			m_nodeTags = gcnew array<IntPtr>(0);
+		}
+
+		void Fill(const Native::ElementChunkView& view)
+		{
+			m_dim = view.dim;
+			m_tag = view.tag;
+			m_elementType = view.elementType;
+			m_nodesPerElement = static_cast<int>(view.nodesPerElement);
+			m_offset = static_cast<long long>(view.offset);
+			m_count = static_cast<int>(view.count);
+
+			int numNodes = m_count * m_nodesPerElement;
+			if (m_nodeTags->Length < numNodes)
+				m_nodeTags = gcnew array<IntPtr>(m_elementTags->Length * m_nodesPerElement);
+
+			if (m_count < 1) return;
+
+			Marshal::Copy(IntPtr(const_cast<size_t*>(view.elementTags)), m_elementTags, 0, m_count);
+			Marshal::Copy(IntPtr(const_cast<size_t*>(view.nodeTags)), m_nodeTags, 0, numNodes);
+		}
+
+	private:
+		int m_dim, m_tag, m_elementType, m_nodesPerElement, m_count;
+		long long m_offset;
+		array<IntPtr>^ m_elementTags;
+		array<IntPtr>^ m_nodeTags;
+	};
+
+	/// <summary>
+	/// The elements of the current model in bounded chunks, entity by entity and type
+	/// by type. Only one (entity, type) block is held in native memory at a time, plus
+	/// a few chunk buffers. With prefetch the next chunk is extracted on a worker
+	/// thread while the caller processes the current one; gmsh must not be used from
+	/// other threads while a prefetching enumeration is running. Dispose the
+	/// enumerator (foreach and LINQ do) to stop the worker; one that is dropped
+	/// without Dispose, as in a manual MoveNext loop, is stopped when finalized.
+	/// </summary>
+	public ref class ElementStream : System::Collections::Generic::IEnumerable<ElementChunk^>
+	{
+	public:
+		// All entities of dimension 'dim' (all dimensions if dim < 0), or only entity
+		// (dim, tag) if tag >= 0, which needs dim >= 0.
+		ElementStream(int dim, int tag, int chunkSize, bool prefetch)
+			: m_dim(dim), m_tag(tag), m_chunkSize(chunkSize), m_prefetch(prefetch)
+		{
+			if (chunkSize < 1) throw gcnew System::ArgumentOutOfRangeException("chunkSize");
+			if (tag >= 0 && dim < 0) throw gcnew System::ArgumentException("A single entity needs its dimension.", "dim");
+		}
+
+		virtual System::Collections::Generic::IEnumerator<ElementChunk^>^ GetEnumerator()
+		{
+			return gcnew Enumerator(m_dim, m_tag, m_chunkSize, m_prefetch);
+		}
+
+		virtual System::Collections::IEnumerator^ GetEnumeratorNonGeneric() = System::Collections::IEnumerable::GetEnumerator
+		{
+			return GetEnumerator();
+		}
+
+	private:
+		// Fills chunks on a worker thread. It owns the cursor, which it deletes when it
+		// stops, and does not refer to the enumerator, so an abandoned enumerator can
+		// still be collected and cancel it from its finalizer.
+		ref class Producer
+		{
+		public:
+			Producer(Native::ElementCursor* cursor, int chunkSize) : m_cursor(cursor)
+			{
+				// One chunk with the caller, one being filled, one queued
+				Free = gcnew System::Collections::Concurrent::BlockingCollection<ElementChunk^>();
+				Full = gcnew System::Collections::Concurrent::BlockingCollection<ElementChunk^>(1);
+				for (int i = 0; i < 3; ++i)
+					Free->Add(gcnew ElementChunk(chunkSize));
+
+				Cancel = gcnew System::Threading::CancellationTokenSource();
+			}
+
+			void Run()
+			{
+				try
+				{
+					Native::ElementChunkView view;
+					while (m_cursor->Next(view))
+					{
+						ElementChunk^ chunk = Free->Take(Cancel->Token);
+						chunk->Fill(view);
+						Full->Add(chunk, Cancel->Token);
+					}
+				}
+				catch (System::OperationCanceledException^) {}
+				catch (System::Exception^ e)
+				{
+					Error = e;
+				}
+				finally
+				{
+					delete m_cursor;
+					m_cursor = nullptr;
+					Full->CompleteAdding();
+				}
+			}
+
+			System::Collections::Concurrent::BlockingCollection<ElementChunk^>^ Free;
+			System::Collections::Concurrent::BlockingCollection<ElementChunk^>^ Full;
+			System::Threading::CancellationTokenSource^ Cancel;
+			System::Exception^ Error;
+
+		private:
+			Native::ElementCursor* m_cursor;
+		};
+
+		ref class Enumerator : System::Collections::Generic::IEnumerator<ElementChunk^>
+		{
+		public:
+			Enumerator(int dim, int tag, int chunkSize, bool prefetch)
+			{
+				Native::ElementCursor* cursor;
+				try
+				{
+					cursor = new Native::ElementCursor(dim, tag, static_cast<size_t>(chunkSize));
+				}
+				catch (const std::invalid_argument& e)
+				{
+					throw gcnew System::ArgumentException(gcnew System::String(e.what()));
+				}
+
+				if (!prefetch)
+				{
+					m_cursor = cursor;
+					m_chunk = gcnew ElementChunk(chunkSize);
+					return;
+				}
+
+				m_producer = gcnew Producer(cursor, chunkSize);
+				m_task = System::Threading::Tasks::Task::Run(gcnew System::Action(m_producer, &Producer::Run));
+			}
+
+			~Enumerator()
+			{
+				if (m_task != nullptr)
+				{
+					m_producer->Cancel->Cancel();
+					try { m_task->Wait(); }
+					catch (System::AggregateException^) {}
+					m_task = nullptr;
+				}
+
+				this->!Enumerator();
+			}
+
+			!Enumerator()
+			{
+				// Only signals the worker; it deletes its cursor itself once it stops
+				if (m_producer != nullptr)
+				{
+					m_producer->Cancel->Cancel();
+					m_producer = nullptr;
+				}
+
+				delete m_cursor;
+				m_cursor = nullptr;
+			}
+
+			virtual bool MoveNext()
+			{
+				if (m_cursor == nullptr && m_producer == nullptr) throw gcnew System::ObjectDisposedException("ElementStream");
+
+				if (m_producer == nullptr)
+				{
+					Native::ElementChunkView view;
+					if (!m_cursor->Next(view))
+					{
+						m_current = nullptr;
+						return false;
+					}
+
+					m_chunk->Fill(view);
+					m_current = m_chunk;
+					return true;
+				}
+
+				// Hand the previous chunk back before waiting for the next one
+				if (m_current != nullptr)
+					m_producer->Free->Add(m_current);
+
+				ElementChunk^ next;
+				if (!m_producer->Full->TryTake(next, System::Threading::Timeout::Infinite))
+				{
+					m_current = nullptr;
+					if (m_producer->Error != nullptr)
+						throw gcnew System::InvalidOperationException("Element extraction failed.", m_producer->Error);
+					return false;
+				}
+
+				m_current = next;
+				return true;
+			}
+
+			virtual void Reset()
+			{
+				throw gcnew System::NotSupportedException();
+			}
+
+			property ElementChunk^ Current
+			{
+				virtual ElementChunk^ get() { return m_current; }
+			}
+
+			property System::Object^ CurrentNonGeneric
+			{
+				virtual System::Object^ get() = System::Collections::IEnumerator::Current::get { return m_current; }
+			}
+
+		private:
+			Native::ElementCursor* m_cursor;
+			ElementChunk^ m_chunk;
+			ElementChunk^ m_current;
+
+			Producer^ m_producer;
+			System::Threading::Tasks::Task^ m_task;
+		};
+
+		int m_dim, m_tag, m_chunkSize;
+		bool m_prefetch;
+	};
+}
@@ -0,0 +1,335 @@
+// Compiled as native code.
+#include "FieldGraph.h"
+#include "ContentHash.h"
+
+#include "gmsh.h"
+
+#include <map>
+#include <stdexcept>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			// Fields created by one Install, with their types, and how many graphs use
+			// them. 'id' tells a later install of the same content apart.
+			struct Installation
+			{
+				size_t id;
+				size_t owners;
+				std::vector<int> tags;
+				std::vector<std::string> types;
+			};
+
+			// The graphs installed so far, by content.
+			std::map<std::string, Installation>& Installed()
+			{
+				static std::map<std::string, Installation> installed;
+				return installed;
+			}
+
+			size_t NextInstallation()
+			{
+				static size_t next = 0;
+				return ++next;
+			}
+
+			// Removes the fields of 'installation' that still exist with their own type,
+			// so a tag since reused for another field is left alone.
+			void RemoveFields(const Installation& installation)
+			{
+				std::vector<int> existing;
+				gmsh::model::mesh::field::list(existing);
+
+				std::string type;
+				for (size_t i = 0; i < installation.tags.size(); ++i)
+				{
+					int tag = installation.tags[i];
+					for (int other : existing)
+					{
+						if (other != tag) continue;
+
+						gmsh::model::mesh::field::getType(tag, type);
+						if (type == installation.types[i])
+						{
+							gmsh::model::mesh::field::remove(tag);
+							Record("field::remove", tag);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		void FieldGraph::Release()
+		{
+			// Give up the fields without removing them, so an identical graph can still reuse them
+			std::map<std::string, Installation>::iterator found = Installed().find(m_digest);
+			if (m_installation != 0 && found != Installed().end() && found->second.id == m_installation && found->second.owners > 0)
+				--found->second.owners;
+
+			m_installation = 0;
+		}
+
+		int FieldGraph::Add(const std::string& type)
+		{
+			FieldNode node;
+			node.type = type;
+			m_nodes.push_back(node);
+			return static_cast<int>(m_nodes.size()) - 1;
+		}
+
+		void FieldGraph::SetNumber(int node, const std::string& option, double value)
+		{
+			Option(node, option, FieldOption::Number).number = value;
+		}
+
+		void FieldGraph::SetNumbers(int node, const std::string& option, const std::vector<double>& values)
+		{
+			Option(node, option, FieldOption::Numbers).numbers = values;
+		}
+
+		void FieldGraph::SetString(int node, const std::string& option, const std::string& value)
+		{
+			Option(node, option, FieldOption::String).text = value;
+		}
+
+		void FieldGraph::SetField(int node, const std::string& option, int field)
+		{
+			Option(node, option, FieldOption::Field).nodes.assign(1, field);
+		}
+
+		void FieldGraph::SetFields(int node, const std::string& option, const std::vector<int>& fields)
+		{
+			Option(node, option, FieldOption::Fields).nodes = fields;
+		}
+
+		void FieldGraph::SetAsBackgroundMesh(int node)
+		{
+			CheckNode(node);
+			m_background = node;
+		}
+
+		void FieldGraph::SetAsBoundaryLayer(int node)
+		{
+			CheckNode(node);
+			m_boundaryLayers.push_back(node);
+		}
+
+		bool FieldGraph::Install()
+		{
+			for (const FieldNode& node : m_nodes)
+				for (const FieldOption& option : node.options)
+					for (int other : option.nodes)
+						if (other < 0 || static_cast<size_t>(other) >= m_nodes.size())
+							throw std::invalid_argument("Field reference out of range.");
+
+			std::string digest = Digest();
+			Record("fieldGraph", digest);
+
+			std::map<std::string, Installation>::iterator found = Installed().find(digest);
+			if (found != Installed().end())
+			{
+				if (IsInPlace(found->second.tags))
+				{
+					if (found->second.id != m_installation)
+					{
+						Remove();
+						++found->second.owners;
+						m_tags = found->second.tags;
+						m_digest = digest;
+						m_installation = found->second.id;
+					}
+
+					// Not queryable, so set again; it is a single call
+					if (m_background >= 0)
+						gmsh::model::mesh::field::setAsBackgroundMesh(m_tags[m_background]);
+					return false;
+				}
+
+				// Changed or partly removed since: no graph can use these fields any more
+				RemoveFields(found->second);
+				Installed().erase(found);
+			}
+
+			Remove();
+
+			m_tags.resize(m_nodes.size());
+			for (size_t i = 0; i < m_nodes.size(); ++i)
+				m_tags[i] = gmsh::model::mesh::field::add(m_nodes[i].type);
+
+			std::vector<double> tags;
+			for (size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				for (const FieldOption& option : m_nodes[i].options)
+				{
+					switch (option.kind)
+					{
+					case FieldOption::Number:
+						gmsh::model::mesh::field::setNumber(m_tags[i], option.name, option.number);
+						break;
+					case FieldOption::Numbers:
+						gmsh::model::mesh::field::setNumbers(m_tags[i], option.name, option.numbers);
+						break;
+					case FieldOption::String:
+						gmsh::model::mesh::field::setString(m_tags[i], option.name, option.text);
+						break;
+					case FieldOption::Field:
+						gmsh::model::mesh::field::setNumber(m_tags[i], option.name, m_tags[option.nodes[0]]);
+						break;
+					case FieldOption::Fields:
+						tags.clear();
+						for (int other : option.nodes)
+							tags.push_back(m_tags[other]);
+						gmsh::model::mesh::field::setNumbers(m_tags[i], option.name, tags);
+						break;
+					}
+				}
+			}
+
+			if (m_background >= 0)
+				gmsh::model::mesh::field::setAsBackgroundMesh(m_tags[m_background]);
+			for (int node : m_boundaryLayers)
+				gmsh::model::mesh::field::setAsBoundaryLayer(m_tags[node]);
+
+			Installation installation;
+			installation.id = NextInstallation();
+			installation.owners = 1;
+			installation.tags = m_tags;
+			for (const FieldNode& node : m_nodes)
+				installation.types.push_back(node.type);
+
+			m_digest = digest;
+			m_installation = installation.id;
+			Installed()[digest] = installation;
+			return true;
+		}
+
+		void FieldGraph::Remove()
+		{
+			// Fields of an installation that has since been dropped are already gone
+			std::map<std::string, Installation>::iterator found = Installed().find(m_digest);
+			if (m_installation != 0 && found != Installed().end() && found->second.id == m_installation)
+			{
+				if (found->second.owners > 0) --found->second.owners;
+				if (found->second.owners == 0)
+				{
+					RemoveFields(found->second);
+					Installed().erase(found);
+				}
+			}
+
+			m_tags.clear();
+			m_digest.clear();
+			m_installation = 0;
+		}
+
+		FieldOption& FieldGraph::Option(int node, const std::string& option, FieldOption::Kind kind)
+		{
+			CheckNode(node);
+
+			std::vector<FieldOption>& options = m_nodes[node].options;
+			for (FieldOption& existing : options)
+			{
+				if (existing.name == option)
+				{
+					existing.kind = kind;
+					return existing;
+				}
+			}
+
+			FieldOption added;
+			added.name = option;
+			added.kind = kind;
+			added.number = 0;
+			options.push_back(added);
+			return options.back();
+		}
+
+		void FieldGraph::CheckNode(int node) const
+		{
+			if (node < 0 || static_cast<size_t>(node) >= m_nodes.size())
+				throw std::out_of_range("No such field node.");
+		}
+
+		std::string FieldGraph::Digest() const
+		{
+			ContentHash hash;
+			hash.Add(m_nodes.size());
+			for (const FieldNode& node : m_nodes)
+			{
+				hash.Add(node.type);
+				hash.Add(node.options.size());
+				for (const FieldOption& option : node.options)
+				{
+					hash.Add(option.name);
+					hash.Add(static_cast<int>(option.kind));
+					hash.Add(option.number);
+					hash.Add(option.numbers);
+					hash.Add(option.text);
+					hash.Add(option.nodes);
+				}
+			}
+
+			hash.Add(m_background);
+			hash.Add(m_boundaryLayers);
+			return hash.Digest();
+		}
+
+		// Whether fields with these tags exist and still hold the graph's types and values.
+		bool FieldGraph::IsInPlace(const std::vector<int>& tags) const
+		{
+			if (tags.size() != m_nodes.size()) return false;
+
+			std::vector<int> existing;
+			gmsh::model::mesh::field::list(existing);
+
+			std::string text;
+			std::vector<double> numbers;
+			for (size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				bool exists = false;
+				for (int other : existing)
+					exists = exists || other == tags[i];
+				if (!exists) return false;
+
+				gmsh::model::mesh::field::getType(tags[i], text);
+				if (text != m_nodes[i].type) return false;
+
+				for (const FieldOption& option : m_nodes[i].options)
+				{
+					double number;
+					switch (option.kind)
+					{
+					case FieldOption::Number:
+						gmsh::model::mesh::field::getNumber(tags[i], option.name, number);
+						if (number != option.number) return false;
+						break;
+					case FieldOption::Field:
+						gmsh::model::mesh::field::getNumber(tags[i], option.name, number);
+						if (number != tags[option.nodes[0]]) return false;
+						break;
+					case FieldOption::String:
+						gmsh::model::mesh::field::getString(tags[i], option.name, text);
+						if (text != option.text) return false;
+						break;
+					case FieldOption::Numbers:
+						gmsh::model::mesh::field::getNumbers(tags[i], option.name, numbers);
+						if (numbers != option.numbers) return false;
+						break;
+					case FieldOption::Fields:
+						gmsh::model::mesh::field::getNumbers(tags[i], option.name, numbers);
+						if (numbers.size() != option.nodes.size()) return false;
+						for (size_t j = 0; j < numbers.size(); ++j)
+							if (numbers[j] != tags[option.nodes[j]]) return false;
+						break;
+					}
+				}
+			}
+
+			return true;
+		}
+	}
+}
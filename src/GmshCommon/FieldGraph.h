@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		struct FieldOption
+		{
+			enum Kind { Number, Numbers, String, Field, Fields };
+
+			std::string name;
+			Kind kind;
+			double number;
+			std::vector<double> numbers;
+			std::string text;
+			std::vector<int> nodes;		// Field, Fields: node indices in the graph
+		};
+
+		struct FieldNode
+		{
+			std::string type;
+			std::vector<FieldOption> options;
+		};
+
+		// A mesh size field setup held natively and installed in one go. Fields refer
+		// to each other by node index; the indices are resolved to field tags when
+		// the graph is installed. Installing a graph that is identical to one that is
+		// already in place (by content, so also from another FieldGraph) reuses its
+		// fields instead of rebuilding them. Shared fields are counted, and are only
+		// removed from the model by the last graph that uses them.
+		class FieldGraph
+		{
+		public:
+			FieldGraph() : m_background(-1), m_installation(0) {}
+
+			FieldGraph(const FieldGraph&) = delete;
+			FieldGraph& operator=(const FieldGraph&) = delete;
+
+			int Add(const std::string& type);
+
+			void SetNumber(int node, const std::string& option, double value);
+			void SetNumbers(int node, const std::string& option, const std::vector<double>& values);
+			void SetString(int node, const std::string& option, const std::string& value);
+			void SetField(int node, const std::string& option, int field);
+			void SetFields(int node, const std::string& option, const std::vector<int>& fields);
+
+			void SetAsBackgroundMesh(int node);
+			void SetAsBoundaryLayer(int node);
+
+			size_t Size() const { return m_nodes.size(); }
+
+			// Field tags from the last Install, one per node.
+			const std::vector<int>& Tags() const { return m_tags; }
+
+			// Creates the fields, or finds them already in place. Returns true if
+			// they had to be created. Throws std::invalid_argument for references to
+			// nodes that do not exist.
+			bool Install();
+
+			// Stops using the fields of the last Install, and removes them from the model
+			// unless another graph still uses them.
+			void Remove();
+
+			// Stops using the fields of the last Install but leaves them in the model,
+			// for an identical graph to reuse. Destroying a graph does not do this, as
+			// the share count is only touched on the thread that uses gmsh.
+			void Release();
+
+		private:
+			void CheckNode(int node) const;
+			FieldOption& Option(int node, const std::string& option, FieldOption::Kind kind);
+			std::string Digest() const;
+			bool IsInPlace(const std::vector<int>& tags) const;
+
+			std::vector<FieldNode> m_nodes;
+			int m_background;
+			std::vector<int> m_boundaryLayers;
+
+			std::vector<int> m_tags;
+			std::string m_digest;
+			size_t m_installation;	// Registry entry of the last Install, 0 for none
+		};
+	}
+}
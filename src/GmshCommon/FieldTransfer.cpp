@@ -0,0 +1,183 @@
+// Compiled as native code.
+#include "FieldTransfer.h"
+#include "Parallel.h"
+#include "QualityKernels.h"
+
+#include <algorithm>
+#include <vector>
+#include <immintrin.h>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			const size_t PointsPerTask = 4096;
+
+			void EvaluateRange(const ElementBvh& bvh, const double* values, int numComponents,
+				const int* elements, const double* local, size_t begin, size_t end, double outsideValue, double* output)
+			{
+				const int nodesPerElement = bvh.NodesPerElement();
+				const int* connectivity = bvh.Connectivity().data();
+
+				double weights[8];
+				for (size_t i = begin; i < end; ++i)
+				{
+					double* out = output + i * numComponents;
+					if (elements[i] < 0)
+					{
+						std::fill(out, out + numComponents, outsideValue);
+						continue;
+					}
+
+					ShapeFunctions(nodesPerElement, local + i * 3, weights);
+
+					const int* nodes = connectivity + static_cast<size_t>(elements[i]) * nodesPerElement;
+					for (int c = 0; c < numComponents; ++c)
+					{
+						double sum = 0;
+						for (int n = 0; n < nodesPerElement; ++n)
+							sum += weights[n] * values[static_cast<size_t>(nodes[n]) * numComponents + c];
+						out[c] = sum;
+					}
+				}
+			}
+
+#if GMSHCOMMON_AVX2
+			// Four tetrahedron points per step: barycentric weights from the local
+			// coordinates, nodal values gathered through the connectivity. Blocks with a
+			// point outside the mesh fall back to the scalar path.
+			void EvaluateTetrahedraAvx2(const ElementBvh& bvh, const double* values, int numComponents,
+				const int* elements, const double* local, size_t begin, size_t end, double outsideValue, double* output)
+			{
+				const int* connectivity = bvh.Connectivity().data();
+				const __m128i stride3 = _mm_setr_epi32(0, 3, 6, 9);
+				const __m128i components = _mm_set1_epi32(numComponents);
+
+				size_t i = begin;
+				for (; i + 4 <= end; i += 4)
+				{
+					__m128i element = _mm_loadu_si128(reinterpret_cast<const __m128i*>(elements + i));
+					if (_mm_movemask_ps(_mm_castsi128_ps(element)) != 0)
+					{
+						EvaluateRange(bvh, values, numComponents, elements, local, i, i + 4, outsideValue, output);
+						continue;
+					}
+
+					__m256d u = _mm256_i32gather_pd(local + i * 3, stride3, 8);
+					__m256d v = _mm256_i32gather_pd(local + i * 3 + 1, stride3, 8);
+					__m256d w = _mm256_i32gather_pd(local + i * 3 + 2, stride3, 8);
+					__m256d weight[4] = { _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), u), v), w), u, v, w };
+
+					__m128i first = _mm_slli_epi32(element, 2);
+					__m128i node[4];
+					for (int n = 0; n < 4; ++n)
+						node[n] = _mm_mullo_epi32(_mm_i32gather_epi32(connectivity + n, first, 4), components);
+
+					double result[4];
+					for (int c = 0; c < numComponents; ++c)
+					{
+						__m256d sum = _mm256_mul_pd(weight[0], _mm256_i32gather_pd(values + c, node[0], 8));
+						for (int n = 1; n < 4; ++n)
+							sum = _mm256_add_pd(sum, _mm256_mul_pd(weight[n], _mm256_i32gather_pd(values + c, node[n], 8)));
+
+						_mm256_storeu_pd(result, sum);
+						for (int k = 0; k < 4; ++k)
+							output[(i + k) * numComponents + c] = result[k];
+					}
+				}
+
+				EvaluateRange(bvh, values, numComponents, elements, local, i, end, outsideValue, output);
+			}
+#endif
+
+			typedef void (*RangeFunction)(const ElementBvh&, const double*, int, const int*, const double*, size_t, size_t, double, double*);
+
+			RangeFunction GetRangeFunction(const ElementBvh& bvh, size_t numNodeValues)
+			{
+#if GMSHCOMMON_AVX2
+				// Gather offsets are 32-bit
+				if (bvh.NodesPerElement() == 4 && numNodeValues < 0x7fffffff && HasAvx2())
+					return EvaluateTetrahedraAvx2;
+#else
+				(void)bvh;
+				(void)numNodeValues;
+#endif
+				return EvaluateRange;
+			}
+		}
+
+		void ShapeFunctions(int nodesPerElement, const double* local, double* weights)
+		{
+			double u = local[0], v = local[1], w = local[2];
+			switch (nodesPerElement)
+			{
+			case 3:
+				weights[0] = 1 - u - v;
+				weights[1] = u;
+				weights[2] = v;
+				break;
+			case 4:
+				weights[0] = 1 - u - v - w;
+				weights[1] = u;
+				weights[2] = v;
+				weights[3] = w;
+				break;
+			case 8:
+			{
+				// Gmsh hexahedron node ordering
+				static const double corners[8][3] = {
+					{ -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+					{ -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } };
+				for (int n = 0; n < 8; ++n)
+					weights[n] = (1 + corners[n][0] * u) * (1 + corners[n][1] * v) * (1 + corners[n][2] * w) * 0.125;
+				break;
+			}
+			}
+		}
+
+		void EvaluateField(const ElementBvh& bvh, const double* values, int numComponents,
+			const int* elements, const double* local, size_t numPoints, double outsideValue, double* output)
+		{
+			RangeFunction evaluate = GetRangeFunction(bvh, bvh.Coords().size() / 3 * numComponents);
+			size_t numTasks = (numPoints + PointsPerTask - 1) / PointsPerTask;
+
+			ParallelFor(numTasks, [&](size_t task)
+				{
+					size_t begin = task * PointsPerTask, end = std::min(numPoints, begin + PointsPerTask);
+					evaluate(bvh, values, numComponents, elements, local, begin, end, outsideValue, output);
+				});
+		}
+
+		size_t TransferField(const ElementBvh& bvh, const double* values, int numComponents,
+			const double* points, size_t numPoints, double outsideValue, double* output)
+		{
+			RangeFunction evaluate = GetRangeFunction(bvh, bvh.Coords().size() / 3 * numComponents);
+			size_t numTasks = (numPoints + PointsPerTask - 1) / PointsPerTask;
+			std::vector<size_t> found(numTasks, 0);
+
+			// Locate and evaluate one chunk at a time so the located points stay in cache
+			ParallelFor(numTasks, [&](size_t task)
+				{
+					size_t begin = task * PointsPerTask, end = std::min(numPoints, begin + PointsPerTask);
+
+					std::vector<int> elements(end - begin);
+					std::vector<double> local((end - begin) * 3);
+					for (size_t i = begin; i < end; ++i)
+					{
+						elements[i - begin] = bvh.Locate(points + i * 3, local.data() + (i - begin) * 3);
+						if (elements[i - begin] >= 0) ++found[task];
+					}
+
+					evaluate(bvh, values, numComponents, elements.data(), local.data(), 0, end - begin, outsideValue, output + begin * numComponents);
+				});
+
+			size_t total = 0;
+			for (size_t i = 0; i < numTasks; ++i)
+				total += found[i];
+
+			return total;
+		}
+	}
+}
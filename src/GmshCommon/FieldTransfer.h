@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ElementBvh.h"
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Writes the nodal interpolation weights of a linear triangle (3), tetrahedron (4)
+		// or hexahedron (8) at 'local', as returned by ElementBvh::Locate.
+		void ShapeFunctions(int nodesPerElement, const double* local, double* weights);
+
+		// Interpolates 'values' (numComponents per node of the indexed mesh) at points
+		// already located in 'bvh'. Points with element -1 get 'outsideValue'.
+		void EvaluateField(const ElementBvh& bvh, const double* values, int numComponents,
+			const int* elements, const double* local, size_t numPoints, double outsideValue, double* output);
+
+		// Locates 'points' (xyz triplets) and interpolates 'values' there, in parallel.
+		// Returns the number of points inside the mesh.
+		size_t TransferField(const ElementBvh& bvh, const double* values, int numComponents,
+			const double* points, size_t numPoints, double outsideValue, double* output);
+	}
+}
@@ -2,8 +2,27 @@
 
 #include "gmsh.h"
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include <msclr\marshal_cppstd.h>
 
+#include "DimTag.h"
+#include "Centroids.h"
+#include "NativeBuffer.h"
+#include "Scratch.h"
+#include "TetraShell.h"
+#include "SizeProvider.h"
+#include "MeshCache.h"
+#include "OptionProfile.h"
+#include "MeshFieldGraph.h"
+#include "Session.h"
+#include "LogStream.h"
+#include "Instrumentation.h"
+#include "ElementBlocks.h"
+#include "ElementStream.h"
+#include "BrepDescription.h"
+#include "BooleanScheduler.h"
+
 using System::IntPtr; 
 using System::Runtime::InteropServices::Marshal;
 
@@ -18,16 +37,19 @@ namespace GmshCommon {
 		static void InitializeGmsh()
 		{
 			gmsh::initialize();
+			MeshCache::ResetInputs();
 		}
 
 		static void FinalizeGmsh()
 		{
 			gmsh::finalize();
+			MeshCache::ResetInputs();
 		}
 
 		static void Clear()
 		{
 			gmsh::clear();
+			MeshCache::ResetInputs();
 		}
 
 		static void Write(System::String^ filepath)
@@ -38,11 +60,14 @@ namespace GmshCommon {
 		static void Open(System::String^ filepath)
 		{
 			gmsh::open(msclr::interop::marshal_as<std::string>(filepath));
+			MeshCache::ResetInputs();
+			MeshCache::RecordFile(filepath);
 		}
 
 		static void Merge(System::String^ filepath)
 		{
 			gmsh::merge(msclr::interop::marshal_as<std::string>(filepath));
+			MeshCache::RecordFile(filepath);
 		}
 
 		ref class Logger
@@ -59,11 +84,31 @@ namespace GmshCommon {
 			static void Start()
 			{
 				gmsh::logger::start();
+				LogStream::LoggerStarted = true;
 			}
 
 			static void Stop()
 			{
 				gmsh::logger::stop();
+				LogStream::LoggerStarted = false;
+			}
+
+			// When on, the main mesh transfer methods record their time, bytes copied and
+			// managed bytes allocated, and Generate records the stage times gmsh logs.
+			static property bool Instrumentation
+			{
+				bool get() { return GmshCommon::Instrumentation::Enabled; }
+				void set(bool value) { GmshCommon::Instrumentation::Enabled = value; }
+			}
+
+			static InstrumentationSnapshot^ GetInstrumentation()
+			{
+				return GmshCommon::Instrumentation::Snapshot();
+			}
+
+			static void ResetInstrumentation()
+			{
+				GmshCommon::Instrumentation::Reset();
 			}
 
 			static void Write(System::String^ message, System::String^ level)
@@ -91,11 +136,13 @@ namespace GmshCommon {
 			static void Add(System::String^ name)
 			{
 				gmsh::model::add(msclr::interop::marshal_as<std::string>(name));
+				MeshCache::ResetInputs();
 			}
 
 			static void SetCurrent(System::String^ name)
 			{
 				gmsh::model::setCurrent(msclr::interop::marshal_as<std::string>(name));
+				MeshCache::InvalidateInputs();
 			}
 
 			static System::String^ GetCurrent()
@@ -107,9 +154,25 @@ namespace GmshCommon {
 				return gcnew System::String(name.c_str());
 			}
 
+			// Served from MeshCache when it is enabled and holds a matching mesh. With
+			// instrumentation on, the stages are timed from the gmsh log.
 			static void Generate(int dim)
 			{
-				gmsh::model::mesh::generate(dim);
+				long long start = Instrumentation::Begin();
+				if (MeshCache::TryLoad(dim))
+				{
+					Instrumentation::EndCall("Generate (cached)", start, 0, 0);
+					return;
+				}
+
+				if (start != 0)
+					Instrumentation::Generate(dim);
+				else
+					gmsh::model::mesh::generate(dim);
+
+				LogStream::PumpOpen();
+				MeshCache::Store();
+				Instrumentation::EndCall("Generate", start, 0, 0);
 			}
 
 			static int AddDiscreteEntity(int dim, int tag)
@@ -149,6 +212,24 @@ namespace GmshCommon {
 					outDimTags[i] = gcnew System::Tuple<int, int>(nOutDimTags[i].first, nOutDimTags[i].second);
 			}
 
+			static void GetEntities([System::Runtime::InteropServices::Out] array<DimTag>^% dimTags, int dim)
+			{
+				gmsh::vectorpair nDimTags;
+				gmsh::model::getEntities(nDimTags, dim);
+
+				dimTags = Native::ToDimTags(nDimTags);
+			}
+
+			static void GetBoundary(array<DimTag>^ tags, [System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags, System::Boolean combined, System::Boolean oriented, System::Boolean recursive)
+			{
+				gmsh::vectorpair dimTags, nOutDimTags;
+				Native::ToVectorPair(tags, dimTags);
+
+				gmsh::model::getBoundary(dimTags, nOutDimTags, combined, oriented, recursive);
+
+				outDimTags = Native::ToDimTags(nOutDimTags);
+			}
+
 			static System::String^ GetType(int dim, int tag)
 			{
 				std::string value;
@@ -172,6 +253,14 @@ namespace GmshCommon {
 				gmsh::model::removeEntities(dimTags, recursive);
 			}
 
+			static void DeleteEntities(array<DimTag>^ tags, System::Boolean recursive)
+			{
+				gmsh::vectorpair dimTags;
+				Native::ToVectorPair(tags, dimTags);
+
+				gmsh::model::removeEntities(dimTags, recursive);
+			}
+
 			static System::String^ GetEntityName(int dim, int tag)
 			{
 				std::string name;
@@ -222,6 +311,14 @@ namespace GmshCommon {
 				return dimTags;
 			}
 
+			static void GetPhysicalGroups(int dim, [System::Runtime::InteropServices::Out] array<DimTag>^% dimTags)
+			{
+				gmsh::vectorpair nDimTags;
+				gmsh::model::getPhysicalGroups(nDimTags, dim);
+
+				dimTags = Native::ToDimTags(nDimTags);
+			}
+
 			static array<int>^ GetEntitiesForPhysicalGroup(int dim, int tag)
 			{
 				std::vector<int> tags;
@@ -246,6 +343,14 @@ namespace GmshCommon {
 				gmsh::model::removePhysicalGroups(nDimTags);
 			}
 
+			static void RemovePhysicalGroups(array<DimTag>^ dimTags)
+			{
+				gmsh::vectorpair nDimTags;
+				Native::ToVectorPair(dimTags, nDimTags);
+
+				gmsh::model::removePhysicalGroups(nDimTags);
+			}
+
 			static array<double>^ GetValue(int dim, int tag, array<double>^ parametricCoord)
 			{
 				std::vector<double> nParametricCoord(parametricCoord->Length);
@@ -277,6 +382,8 @@ namespace GmshCommon {
 
 				static void AddNodes(int dim, int tag, array<IntPtr>^ nodeTags, array<double>^ coordinates)
 				{
+					long long start = Instrumentation::Begin();
+
 					std::vector<size_t> nnodeTags(nodeTags->Length);
 					Marshal::Copy(nodeTags, 0, IntPtr(nnodeTags.data()), nodeTags->Length);
 
@@ -284,6 +391,9 @@ namespace GmshCommon {
 					Marshal::Copy(coordinates, 0, IntPtr(coord.data()), coordinates->Length);
 
 					gmsh::model::mesh::addNodes(dim, tag, nnodeTags, coord);
+					Native::Record("addNodes", dim, tag, nnodeTags, coord);
+
+					Instrumentation::EndCall("Mesh.AddNodes", start, nnodeTags.size() * sizeof(size_t) + coord.size() * sizeof(double), 0);
 				}
 
 				static void AddFaces(int faceType, array<IntPtr>^ faceTags, array<IntPtr>^ faceNodes)
@@ -294,10 +404,13 @@ namespace GmshCommon {
 					Marshal::Copy(faceNodes, 0, IntPtr(nFaceNodes.data()), faceNodes->Length);
 
 					gmsh::model::mesh::addFaces(faceType, nFaceTags, nFaceNodes);
+					Native::Record("addFaces", faceType, nFaceTags, nFaceNodes);
 				}
 
 				static void AddElements(int dim, int tag, array<int>^ elementTypes, array < array<IntPtr>^>^ elementTags, array < array<IntPtr>^>^ nodeTags)
 				{
+					long long start = Instrumentation::Begin();
+
 					std::vector<int> nElementTypes(elementTypes->Length);
 					Marshal::Copy(elementTypes, 0, IntPtr(nElementTypes.data()), elementTypes->Length);
 
@@ -316,16 +429,55 @@ namespace GmshCommon {
 					}
 
 					gmsh::model::mesh::addElements(dim, tag, nElementTypes, nElementTags, nNodeTags);
+					Native::Record("addElements", dim, tag, nElementTypes, nElementTags, nNodeTags);
+
+					Instrumentation::EndCall("Mesh.AddElements", start, Native::TagBytes(nElementTags) + Native::TagBytes(nNodeTags), 0);
+				}
+
+				static void AddElements(int dim, int tag, ElementBlocks^ blocks)
+				{
+					long long start = Instrumentation::Begin();
+
+					std::vector<int> nElementTypes(blocks->NumBlocks);
+					std::vector<std::vector<size_t>> nElementTags(blocks->NumBlocks), nNodeTags(blocks->NumBlocks);
+
+					if (blocks->NumBlocks > 0)
+						Marshal::Copy(blocks->ElementTypes, 0, IntPtr(nElementTypes.data()), blocks->NumBlocks);
+
+					if (blocks->ElementTags->Length > 0)
+					{
+						pin_ptr<IntPtr> pinned = &blocks->ElementTags[0];
+						const size_t* ptr = reinterpret_cast<const size_t*>(static_cast<IntPtr*>(pinned));
+
+						for (int i = 0; i < blocks->NumBlocks; ++i)
+							nElementTags[i].assign(ptr + blocks->ElementOffsets[i], ptr + blocks->ElementOffsets[i + 1]);
+					}
+
+					if (blocks->NodeTags->Length > 0)
+					{
+						pin_ptr<IntPtr> pinned = &blocks->NodeTags[0];
+						const size_t* ptr = reinterpret_cast<const size_t*>(static_cast<IntPtr*>(pinned));
+
+						for (int i = 0; i < blocks->NumBlocks; ++i)
+							nNodeTags[i].assign(ptr + blocks->NodeOffsets[i], ptr + blocks->NodeOffsets[i + 1]);
+					}
+
+					gmsh::model::mesh::addElements(dim, tag, nElementTypes, nElementTags, nNodeTags);
+					Native::Record("addElements", dim, tag, nElementTypes, nElementTags, nNodeTags);
+
+					Instrumentation::EndCall("Mesh.AddElements (blocks)", start, Native::TagBytes(nElementTags) + Native::TagBytes(nNodeTags), 0);
 				}
 
 				static void ClassifySurfaces(double angle, System::Boolean boundary, System::Boolean forReparametrization, double curveAngle, System::Boolean exportDiscrete)
 				{
 					gmsh::model::mesh::classifySurfaces(angle, boundary, forReparametrization, curveAngle, exportDiscrete);
+					Native::Record("classifySurfaces", angle, boundary, forReparametrization, curveAngle, exportDiscrete);
 				}
 
 				static void CreateGeometry()
 				{
 					gmsh::model::mesh::createGeometry();
+					Native::Record("createGeometry");
 				}
 
 				static void CreateTopology()
@@ -336,7 +488,7 @@ namespace GmshCommon {
 				static void CreateTopology(System::Boolean makeSimplyConnected, System::Boolean exportDiscrete)
 				{
 					gmsh::model::mesh::createTopology(makeSimplyConnected, exportDiscrete);
-
+					Native::Record("createTopology", makeSimplyConnected, exportDiscrete);
 				}
 
 				static void GetIntegrationPoints(int elementType, System::String^ integrationType,
@@ -375,6 +527,8 @@ namespace GmshCommon {
 
 				static void GetNodes([System::Runtime::InteropServices::Out] array<IntPtr>^% nodeTags, [System::Runtime::InteropServices::Out] array<double>^% coord, int dim, int tag, System::Boolean includeBoundary, System::Boolean returnParametricCoord)
 				{
+					long long start = Instrumentation::Begin();
+
 					std::vector<size_t> nodeTags_native;
 					std::vector<double> coord_native, parametricCoord_native;
 					gmsh::model::mesh::getNodes(nodeTags_native, coord_native, parametricCoord_native, dim, tag, includeBoundary, returnParametricCoord);
@@ -390,6 +544,58 @@ namespace GmshCommon {
 					nodeTags = gcnew array<IntPtr>(nodeTags_native.size());
 					if (nodeTags_native.size() > 0)
 						Marshal::Copy(IntPtr(nodeTags_native.data()), nodeTags, 0, nodeTags_native.size());
+
+					long long bytes = nodeTags_native.size() * sizeof(size_t) + coord_native.size() * sizeof(double);
+					Instrumentation::EndCall("Mesh.GetNodes", start, bytes, bytes);
+				}
+
+				static void GetNodes([System::Runtime::InteropServices::Out] NativeBuffer^% nodeTags, [System::Runtime::InteropServices::Out] NativeBuffer^% coord, [System::Runtime::InteropServices::Out] NativeBuffer^% parametricCoord, int dim, int tag, System::Boolean includeBoundary, System::Boolean returnParametricCoord)
+				{
+					long long start = Instrumentation::Begin();
+
+					std::vector<size_t> nodeTags_native;
+					std::vector<double> coord_native, parametricCoord_native;
+					gmsh::model::mesh::getNodes(nodeTags_native, coord_native, parametricCoord_native, dim, tag, includeBoundary, returnParametricCoord);
+
+					nodeTags = Native::Adopt(nodeTags_native);
+					coord = Native::Adopt(coord_native);
+					parametricCoord = Native::Adopt(parametricCoord_native);
+
+					Instrumentation::EndCall("Mesh.GetNodes (NativeBuffer)", start, 0, 0);
+				}
+
+				// Frees the native buffers kept between calls by the caller-buffer overloads
+				// (GetNodes, GetElementsByType, GetJacobians, GetBarycenters). Those overloads
+				// share the buffers and must be called from one thread at a time.
+				static void ReleaseScratch()
+				{
+					Native::ReleaseScratch();
+				}
+
+				// Fills caller-owned buffers and returns the number of nodes. Nothing is copied
+				// unless both buffers are large enough (coord needs 3 values per node), so
+				// passing null buffers queries the required size.
+				static int GetNodes(int dim, int tag, System::Boolean includeBoundary, array<IntPtr>^ nodeTags, array<double>^ coord)
+				{
+					long long start = Instrumentation::Begin();
+
+					Native::Scratch& scratch = Native::GetScratch();
+					scratch.nodeTags.clear();
+					scratch.coord.clear();
+					scratch.parametricCoord.clear();
+
+					gmsh::model::mesh::getNodes(scratch.nodeTags, scratch.coord, scratch.parametricCoord, dim, tag, includeBoundary, false);
+
+					long long bytes = 0;
+					if (Native::Fits(scratch.nodeTags, nodeTags) && Native::Fits(scratch.coord, coord))
+					{
+						Native::CopyOut(scratch.nodeTags, nodeTags);
+						Native::CopyOut(scratch.coord, coord);
+						bytes = scratch.nodeTags.size() * sizeof(size_t) + scratch.coord.size() * sizeof(double);
+					}
+
+					Instrumentation::EndCall("Mesh.GetNodes (caller buffers)", start, bytes, 0);
+					return static_cast<int>(scratch.nodeTags.size());
 				}
 
 				static void GetElement(IntPtr elementTag, int elementType,
@@ -441,6 +647,8 @@ namespace GmshCommon {
 					[System::Runtime::InteropServices::Out] array< array<IntPtr>^>^% nodeTags,
 					int dim, int tag)
 				{
+					long long start = Instrumentation::Begin();
+
 					std::vector<int> elementTypesN;
 					std::vector<std::vector<size_t>> elementTagsN, nodeTagsN;
 
@@ -492,16 +700,236 @@ namespace GmshCommon {
 						//}
 					}
 
+					long long bytes = elementTypesN.size() * sizeof(int) + Native::TagBytes(elementTagsN) + Native::TagBytes(nodeTagsN);
+					Instrumentation::EndCall("Mesh.GetElements", start, bytes, bytes);
+				}
+
+				static void GetElements(
+					[System::Runtime::InteropServices::Out] array<int>^% elementTypes,
+					[System::Runtime::InteropServices::Out] array<NativeBuffer^>^% elementTags,
+					[System::Runtime::InteropServices::Out] array<NativeBuffer^>^% nodeTags,
+					int dim, int tag)
+				{
+					long long start = Instrumentation::Begin();
+
+					std::vector<int> elementTypesN;
+					std::vector<std::vector<size_t>> elementTagsN, nodeTagsN;
+
+					gmsh::model::mesh::getElements(elementTypesN, elementTagsN, nodeTagsN, dim, tag);
+
+					elementTypes = gcnew array<int>(elementTypesN.size());
+					if (elementTypesN.size() > 0)
+						Marshal::Copy(IntPtr(elementTypesN.data()), elementTypes, 0, elementTypesN.size());
+
+					elementTags = gcnew array<NativeBuffer^>(elementTagsN.size());
+					for (int i = 0; i < elementTagsN.size(); ++i)
+						elementTags[i] = Native::Adopt(elementTagsN[i]);
+
+					nodeTags = gcnew array<NativeBuffer^>(nodeTagsN.size());
+					for (int i = 0; i < nodeTagsN.size(); ++i)
+						nodeTags[i] = Native::Adopt(nodeTagsN[i]);
+
+					Instrumentation::EndCall("Mesh.GetElements (NativeBuffer)", start, 0, 0);
+				}
+
+				static ElementBlocks^ GetElementBlocks(int dim, int tag)
+				{
+					long long start = Instrumentation::Begin();
+
+					std::vector<int> elementTypesN;
+					std::vector<std::vector<size_t>> elementTagsN, nodeTagsN;
+
+					gmsh::model::mesh::getElements(elementTypesN, elementTagsN, nodeTagsN, dim, tag);
+
+					int numBlocks = static_cast<int>(elementTypesN.size());
+					array<int>^ elementTypes = gcnew array<int>(numBlocks);
+					array<int>^ elementCounts = gcnew array<int>(numBlocks);
+					array<int>^ nodesPerElement = gcnew array<int>(numBlocks);
+
+					size_t numElements = 0, numNodes = 0;
+					for (int i = 0; i < numBlocks; ++i)
+					{
+						elementTypes[i] = elementTypesN[i];
+						elementCounts[i] = static_cast<int>(elementTagsN[i].size());
+						nodesPerElement[i] = elementTagsN[i].size() > 0 ? static_cast<int>(nodeTagsN[i].size() / elementTagsN[i].size()) : 0;
+
+						numElements += elementTagsN[i].size();
+						numNodes += nodeTagsN[i].size();
+					}
+
+					array<IntPtr>^ elementTags = gcnew array<IntPtr>(static_cast<int>(numElements));
+					array<IntPtr>^ nodeTags = gcnew array<IntPtr>(static_cast<int>(numNodes));
+
+					if (numElements > 0)
+					{
+						pin_ptr<IntPtr> pinned = &elementTags[0];
+						size_t* ptr = reinterpret_cast<size_t*>(static_cast<IntPtr*>(pinned));
+						for (int i = 0; i < numBlocks; ++i)
+						{
+							std::memcpy(ptr, elementTagsN[i].data(), elementTagsN[i].size() * sizeof(size_t));
+							ptr += elementTagsN[i].size();
+						}
+					}
+
+					if (numNodes > 0)
+					{
+						pin_ptr<IntPtr> pinned = &nodeTags[0];
+						size_t* ptr = reinterpret_cast<size_t*>(static_cast<IntPtr*>(pinned));
+						for (int i = 0; i < numBlocks; ++i)
+						{
+							std::memcpy(ptr, nodeTagsN[i].data(), nodeTagsN[i].size() * sizeof(size_t));
+							ptr += nodeTagsN[i].size();
+						}
+					}
+
+					long long bytes = (numElements + numNodes) * sizeof(size_t);
+					Instrumentation::EndCall("Mesh.GetElementBlocks", start, bytes, bytes + 3 * numBlocks * sizeof(int));
+					return gcnew ElementBlocks(elementTypes, elementCounts, nodesPerElement, elementTags, nodeTags);
+				}
+
+				// Streams the elements of entity (dim, tag), or of all entities of dimension dim
+				// if tag < 0, in chunks of at most chunkSize elements per entity and type. The
+				// next chunk is extracted while the caller handles the current one.
+				static ElementStream^ GetElementChunks(int dim, int tag, int chunkSize)
+				{
+					return gcnew ElementStream(dim, tag, chunkSize, true);
+				}
+
+				// Fills caller-owned buffers with the elements of one type and returns the number
+				// of elements. Nothing is copied unless both buffers are large enough.
+				static int GetElementsByType(int elementType, int tag, array<IntPtr>^ elementTags, array<IntPtr>^ nodeTags)
+				{
+					long long start = Instrumentation::Begin();
+
+					Native::Scratch& scratch = Native::GetScratch();
+					scratch.elementTags.clear();
+					scratch.nodeTags.clear();
+
+					gmsh::model::mesh::getElementsByType(elementType, scratch.elementTags, scratch.nodeTags, tag);
+
+					long long bytes = 0;
+					if (Native::Fits(scratch.elementTags, elementTags) && Native::Fits(scratch.nodeTags, nodeTags))
+					{
+						Native::CopyOut(scratch.elementTags, elementTags);
+						Native::CopyOut(scratch.nodeTags, nodeTags);
+						bytes = (scratch.elementTags.size() + scratch.nodeTags.size()) * sizeof(size_t);
+					}
+
+					Instrumentation::EndCall("Mesh.GetElementsByType (caller buffers)", start, bytes, 0);
+					return static_cast<int>(scratch.elementTags.size());
+				}
+
+				// Gathers the triangles and quads of a set of entities into one indexed surface
+				// mesh. Volumes contribute their boundary surfaces. Nodes shared between
+				// surfaces appear once; indices are zero-based into 'vertices' (xyz triplets).
+				static void ExtractSurfaceMesh(array<DimTag>^ dimTags,
+					[System::Runtime::InteropServices::Out] array<double>^% vertices,
+					[System::Runtime::InteropServices::Out] array<int>^% triangles,
+					[System::Runtime::InteropServices::Out] array<int>^% quads)
+				{
+					gmsh::vectorpair given, input, surfaces;
+					Native::ToVectorPair(dimTags, given);
+
+					// A negative tag stands for every entity of its dimension
+					for (const std::pair<int, int>& dimTag : given)
+					{
+						if (dimTag.second >= 0)
+							input.push_back(dimTag);
+						else
+						{
+							gmsh::vectorpair all;
+							gmsh::model::getEntities(all, dimTag.first);
+							input.insert(input.end(), all.begin(), all.end());
+						}
+					}
+
+					for (int i = 0; i < input.size(); ++i)
+					{
+						if (input[i].first == 3)
+						{
+							gmsh::vectorpair boundary;
+							gmsh::model::getBoundary({ input[i] }, boundary, true, false, false);
+							surfaces.insert(surfaces.end(), boundary.begin(), boundary.end());
+						}
+						else if (input[i].first == 2)
+							surfaces.push_back(input[i]);
+					}
+
+					if (surfaces.size() < 1) throw gcnew System::Exception("No valid entities present.");
+
+					size_t maxNodeTag = 0;
+					gmsh::model::mesh::getMaxNodeTag(maxNodeTag);
+
+					std::vector<int> index(maxNodeTag + 1, -1);
+					std::vector<double> nVertices;
+					std::vector<int> nTriangles, nQuads;
+
+					std::vector<size_t> nodeTags, elementTags, elementNodes;
+					std::vector<double> coord, parametricCoord;
+
+					for (int i = 0; i < surfaces.size(); ++i)
+					{
+						int tag = surfaces[i].second;
+
+						gmsh::model::mesh::getNodes(nodeTags, coord, parametricCoord, 2, tag, true, false);
+
+						for (int j = 0; j < nodeTags.size(); ++j)
+						{
+							if (index[nodeTags[j]] >= 0) continue;
+
+							index[nodeTags[j]] = static_cast<int>(nVertices.size() / 3);
+							nVertices.insert(nVertices.end(), coord.begin() + j * 3, coord.begin() + j * 3 + 3);
+						}
+
+						// Element types 2 and 3 are 3-node triangles and 4-node quadrangles
+						for (int type = 2; type <= 3; ++type)
+						{
+							elementTags.clear();
+							elementNodes.clear();
+							gmsh::model::mesh::getElementsByType(type, elementTags, elementNodes, tag);
+
+							std::vector<int>& faces = type == 2 ? nTriangles : nQuads;
+							faces.reserve(faces.size() + elementNodes.size());
+
+							// Elements with a node that was not returned for the surface are skipped
+							size_t numElementNodes = type == 2 ? 3 : 4;
+							for (size_t j = 0; j + numElementNodes <= elementNodes.size(); j += numElementNodes)
+							{
+								bool valid = true;
+								for (size_t k = j; k < j + numElementNodes; ++k)
+									valid = valid && elementNodes[k] < index.size() && index[elementNodes[k]] >= 0;
+								if (!valid) continue;
+
+								for (size_t k = j; k < j + numElementNodes; ++k)
+									faces.push_back(index[elementNodes[k]]);
+							}
+						}
+					}
+
+					if (nVertices.size() < 1) throw gcnew System::Exception("Couldn't get any nodes!");
+
+					vertices = gcnew array<double>(static_cast<int>(nVertices.size()));
+					Marshal::Copy(IntPtr(nVertices.data()), vertices, 0, vertices->Length);
+
+					triangles = gcnew array<int>(static_cast<int>(nTriangles.size()));
+					if (triangles->Length > 0)
+						Marshal::Copy(IntPtr(nTriangles.data()), triangles, 0, triangles->Length);
+
+					quads = gcnew array<int>(static_cast<int>(nQuads.size()));
+					if (quads->Length > 0)
+						Marshal::Copy(IntPtr(nQuads.data()), quads, 0, quads->Length);
 				}
 
 				static void RemoveDuplicateNodes()
 				{
 					gmsh::model::mesh::removeDuplicateNodes();
+					Native::Record("removeDuplicateNodes");
 				}
 
 				static void RemoveDuplicateElements()
 				{
 					gmsh::model::mesh::removeDuplicateElements();
+					Native::Record("removeDuplicateElements");
 				}
 
 				static void CreateFaces()
@@ -527,6 +955,15 @@ namespace GmshCommon {
 					//	faceNodes[i] = static_cast<long>(face_nodes[i]);
 				}
 
+				static void GetAllFaces(int dim, [System::Runtime::InteropServices::Out] NativeBuffer^% faceTags, [System::Runtime::InteropServices::Out] NativeBuffer^% faceNodes)
+				{
+					std::vector<size_t> face_tags, face_nodes;
+					gmsh::model::mesh::getAllFaces(dim, face_tags, face_nodes);
+
+					faceTags = Native::Adopt(face_tags);
+					faceNodes = Native::Adopt(face_nodes);
+				}
+
 				static void GetJacobians(int elementType, int tag, array<double>^ localCoord,
 					[System::Runtime::InteropServices::Out] array<double>^% jacobians,
 					[System::Runtime::InteropServices::Out] array<double>^% determinants,
@@ -546,6 +983,47 @@ namespace GmshCommon {
 					Marshal::Copy(IntPtr(nCoord.data()), coord, 0, nCoord.size());
 				}
 
+				static void GetJacobians(int elementType, int tag, array<double>^ localCoord,
+					[System::Runtime::InteropServices::Out] NativeBuffer^% jacobians,
+					[System::Runtime::InteropServices::Out] NativeBuffer^% determinants,
+					[System::Runtime::InteropServices::Out] NativeBuffer^% coord)
+				{
+					std::vector<double> nLocalCoord(localCoord->Length), nJacobians, nDeterminants, nCoord;
+					Marshal::Copy(localCoord, 0, IntPtr(nLocalCoord.data()), localCoord->Length);
+
+					gmsh::model::mesh::getJacobians(elementType, nLocalCoord, nJacobians, nDeterminants, nCoord, tag);
+
+					jacobians = Native::Adopt(nJacobians);
+					determinants = Native::Adopt(nDeterminants);
+					coord = Native::Adopt(nCoord);
+				}
+
+				// Fills caller-owned buffers and returns the number of evaluation points over all
+				// elements (jacobians need 9 values each, coord 3). Nothing is copied unless all
+				// three buffers are large enough.
+				static int GetJacobians(int elementType, int tag, array<double>^ localCoord, array<double>^ jacobians, array<double>^ determinants, array<double>^ coord)
+				{
+					Native::Scratch& scratch = Native::GetScratch();
+					scratch.localCoord.resize(localCoord->Length);
+					if (localCoord->Length > 0)
+						Marshal::Copy(localCoord, 0, IntPtr(scratch.localCoord.data()), localCoord->Length);
+
+					scratch.jacobians.clear();
+					scratch.determinants.clear();
+					scratch.coord.clear();
+
+					gmsh::model::mesh::getJacobians(elementType, scratch.localCoord, scratch.jacobians, scratch.determinants, scratch.coord, tag);
+
+					if (Native::Fits(scratch.jacobians, jacobians) && Native::Fits(scratch.determinants, determinants) && Native::Fits(scratch.coord, coord))
+					{
+						Native::CopyOut(scratch.jacobians, jacobians);
+						Native::CopyOut(scratch.determinants, determinants);
+						Native::CopyOut(scratch.coord, coord);
+					}
+
+					return static_cast<int>(scratch.determinants.size());
+				}
+
 				static array<IntPtr>^ Triangulate(array<double>^ coords)
 				{
 					std::vector<double> nCoords(coords->Length);
@@ -577,10 +1055,48 @@ namespace GmshCommon {
 					return tetra;
 				}
 
-				static void GetLocalCoordinatesInElement(int tag, double x, double y, double z, 
-					[System::Runtime::InteropServices::Out] double u, [System::Runtime::InteropServices::Out] double v, [System::Runtime::InteropServices::Out] double w)
+				// Tetrahedralizes a point cloud, drops tetrahedra that fail the edge length, volume
+				// or gamma tests (maxEdgeLength or maxGamma <= 0 disables that test), and returns
+				// the kept tetrahedra and their outward-facing boundary triangles as zero-based
+				// indices into the input points.
+				static void TetrahedralizeShell(array<double>^ coords, double maxEdgeLength, double minVolume, double maxGamma,
+					[System::Runtime::InteropServices::Out] array<int>^% tetrahedra,
+					[System::Runtime::InteropServices::Out] array<int>^% triangles)
+				{
+					if (coords == nullptr || coords->Length < 12) throw gcnew System::Exception("Invalid points for tetrahedralization.");
+
+					std::vector<double> nCoords(coords->Length);
+					Marshal::Copy(coords, 0, IntPtr(nCoords.data()), coords->Length);
+
+					std::vector<size_t> nTetra;
+					gmsh::algorithm::tetrahedralize(nCoords, nTetra);
+
+					std::vector<int> allTetra(nTetra.size()), keptTetra, nTriangles;
+					for (size_t i = 0; i < nTetra.size(); ++i)
+						allTetra[i] = static_cast<int>(nTetra[i]) - 1;
+
+					Native::TetraFilter filter = { maxEdgeLength, minVolume, maxGamma };
+					Native::FilterTetrahedra(nCoords.data(), allTetra, filter, keptTetra);
+					Native::GetBoundaryFaces(nCoords.data(), nCoords.size() / 3, keptTetra, nTriangles);
+
+					tetrahedra = gcnew array<int>(static_cast<int>(keptTetra.size()));
+					if (keptTetra.size() > 0)
+						Marshal::Copy(IntPtr(keptTetra.data()), tetrahedra, 0, tetrahedra->Length);
+
+					triangles = gcnew array<int>(static_cast<int>(nTriangles.size()));
+					if (nTriangles.size() > 0)
+						Marshal::Copy(IntPtr(nTriangles.data()), triangles, 0, triangles->Length);
+				}
+
+				// For many points use PointLocator, which builds a spatial index once.
+				static void GetLocalCoordinatesInElement(int tag, double x, double y, double z,
+					[System::Runtime::InteropServices::Out] double% u, [System::Runtime::InteropServices::Out] double% v, [System::Runtime::InteropServices::Out] double% w)
 				{
-					gmsh::model::mesh::getLocalCoordinatesInElement(tag, x, y, z, u, v, w);
+					double lu, lv, lw;
+					gmsh::model::mesh::getLocalCoordinatesInElement(tag, x, y, z, lu, lv, lw);
+					u = lu;
+					v = lv;
+					w = lw;
 				}
 
 				static array<double>^ GetBarycenters(int elementType, int tag, bool fast, bool primary, int task, int numTasks)
@@ -594,8 +1110,56 @@ namespace GmshCommon {
 					return coordsOut;
 				}
 
+				static void GetBarycenters(int elementType, int tag, bool fast, bool primary, int task, int numTasks, [System::Runtime::InteropServices::Out] NativeBuffer^% barycenters)
+				{
+					std::vector<double> coords;
+					gmsh::model::mesh::getBarycenters(elementType, tag, fast, primary, coords, task, numTasks);
+
+					barycenters = Native::Adopt(coords);
+				}
+
+				// Fills a caller-owned buffer and returns the number of elements (3 values each).
+				// Nothing is copied unless the buffer is large enough.
+				static int GetBarycenters(int elementType, int tag, bool fast, bool primary, array<double>^ barycenters)
+				{
+					Native::Scratch& scratch = Native::GetScratch();
+					scratch.coord.clear();
+
+					gmsh::model::mesh::getBarycenters(elementType, tag, fast, primary, scratch.coord);
+
+					if (Native::Fits(scratch.coord, barycenters))
+						Native::CopyOut(scratch.coord, barycenters);
+
+					return static_cast<int>(scratch.coord.size() / 3);
+				}
+
+				// Computes all barycenters on the native thread pool, each task filling its own
+				// slice of one preallocated buffer.
+				static array<double>^ GetBarycenters(int elementType, int tag, bool fast, bool primary)
+				{
+					std::vector<double> coords;
+					Native::GetBarycenters(elementType, tag, fast, primary, coords, 0);
+
+					array<double>^ coordsOut = gcnew array<double>(static_cast<int>(coords.size()));
+					if (coords.size() > 0)
+						Marshal::Copy(IntPtr(coords.data()), coordsOut, 0, coordsOut->Length);
+
+					return coordsOut;
+				}
+
+				static void GetBarycenters(int elementType, int tag, bool fast, bool primary, [System::Runtime::InteropServices::Out] NativeBuffer^% barycenters)
+				{
+					std::vector<double> coords;
+					Native::GetBarycenters(elementType, tag, fast, primary, coords, 0);
+
+					barycenters = Native::Adopt(coords);
+				}
+
 				static void SetSizeCallback(MeshSizeCallback^ callback)
 				{
+					// The function pointer is only valid while the delegate is alive
+					s_sizeCallback = callback;
+
 					IntPtr fptr = Marshal::GetFunctionPointerForDelegate(callback);
 
 					typedef double(__stdcall* NativeCallback)(int, int, double, double, double, double);
@@ -603,6 +1167,39 @@ namespace GmshCommon {
 					NativeCallback nativeCallback = static_cast<NativeCallback>(fptr.ToPointer());
 
 					gmsh::model::mesh::setSizeCallback(nativeCallback);
+					MeshCache::SetSizeCallbackInstalled(true);
+				}
+
+				// Installs a native size function. gmsh holds its own reference, so the
+				// provider may be disposed afterwards. With limitToCurrent the size never
+				// exceeds the one gmsh would otherwise use.
+				static void SetSizeCallback(SizeProvider^ provider, bool limitToCurrent)
+				{
+					if (provider == nullptr) throw gcnew System::ArgumentNullException("provider");
+
+					Native::SetSizeProvider(provider->Provider, limitToCurrent);
+					s_sizeCallback = nullptr;
+					MeshCache::SetSizeCallbackInstalled(true);
+				}
+
+				static void SetSizeCallback(SizeProvider^ provider)
+				{
+					SetSizeCallback(provider, false);
+				}
+
+				// Installs sizes sampled on a regular grid as the background size; see SizeProvider.Grid.
+				static void SetSizeGrid(array<double>^ origin, array<double>^ spacing, array<int>^ dims, array<double>^ values, bool limitToCurrent)
+				{
+					SizeProvider^ provider = SizeProvider::Grid(origin, spacing, dims, values);
+					SetSizeCallback(provider, limitToCurrent);
+					delete provider;
+				}
+
+				static void RemoveSizeCallback()
+				{
+					gmsh::model::mesh::removeSizeCallback();
+					s_sizeCallback = nullptr;
+					MeshCache::SetSizeCallbackInstalled(false);
 				}
 
 				static void GetElementFaceNodes(int elementType, int faceType, [System::Runtime::InteropServices::Out] array<IntPtr>^% nodeTags)
@@ -631,7 +1228,11 @@ namespace GmshCommon {
 				public:
 					static int Add(System::String^ fieldType, int tag)
 					{
-						return gmsh::model::mesh::field::add(msclr::interop::marshal_as<std::string>(fieldType), tag);
+						std::string nType = msclr::interop::marshal_as<std::string>(fieldType);
+						int fieldTag = gmsh::model::mesh::field::add(nType, tag);
+						Native::Record("field::add", nType, fieldTag);
+
+						return fieldTag;
 					}
 
 					static double GetNumber(int tag, System::String^ option)
@@ -683,36 +1284,48 @@ namespace GmshCommon {
 					static void Remove(int tag)
 					{
 						gmsh::model::mesh::field::remove(tag);
+						Native::Record("field::remove", tag);
 					}
 
 					static void SetAsBackgroundMesh(int tag)
 					{
 						gmsh::model::mesh::field::setAsBackgroundMesh(tag);
+						Native::Record("field::setAsBackgroundMesh", tag);
 					}
 
 					static void SetAsBoundaryLayer(int tag)
 					{
 						gmsh::model::mesh::field::setAsBoundaryLayer(tag);
+						Native::Record("field::setAsBoundaryLayer", tag);
 					}
 
 					static void SetNumber(int tag, System::String^ option, double value)
 					{
-						gmsh::model::mesh::field::setNumber(tag, msclr::interop::marshal_as<std::string>(option), value);
+						std::string nOption = msclr::interop::marshal_as<std::string>(option);
+						gmsh::model::mesh::field::setNumber(tag, nOption, value);
+						Native::Record("field::setNumber", tag, nOption, value);
 					}
 
 					static void SetNumbers(int tag, System::String^ option, array<double>^ values)
 					{
 						std::vector<double> nValues(values->Length);
 						Marshal::Copy(values, 0, IntPtr(nValues.data()), values->Length);
-						gmsh::model::mesh::field::setNumbers(tag, msclr::interop::marshal_as<std::string>(option), nValues);
+						std::string nOption = msclr::interop::marshal_as<std::string>(option);
+						gmsh::model::mesh::field::setNumbers(tag, nOption, nValues);
+						Native::Record("field::setNumbers", tag, nOption, nValues);
 					}
 
 					static void SetString(int tag, System::String^ option, System::String^ value)
 					{
-						gmsh::model::mesh::field::setString(tag, msclr::interop::marshal_as<std::string>(option), msclr::interop::marshal_as<std::string>(value));
+						std::string nOption = msclr::interop::marshal_as<std::string>(option), nValue = msclr::interop::marshal_as<std::string>(value);
+						gmsh::model::mesh::field::setString(tag, nOption, nValue);
+						Native::Record("field::setString", tag, nOption, nValue);
 					}
 
 				};
+
+			private:
+				static MeshSizeCallback^ s_sizeCallback;
 			};
 
 
@@ -734,7 +1347,10 @@ namespace GmshCommon {
 					std::vector<int> nShellTags(shellTags->Length);
 					Marshal::Copy(shellTags, 0, IntPtr(nShellTags.data()), shellTags->Length);
 
-					return gmsh::model::geo::addVolume(nShellTags, tag);
+					int volumeTag = gmsh::model::geo::addVolume(nShellTags, tag);
+					Native::Record("geo::addVolume", nShellTags, volumeTag);
+
+					return volumeTag;
 				}
 
 
@@ -748,7 +1364,10 @@ namespace GmshCommon {
 					std::vector<int> nSurfaceTags(surfaceTags->Length);
 					Marshal::Copy(surfaceTags, 0, IntPtr(nSurfaceTags.data()), surfaceTags->Length);
 
-					return gmsh::model::geo::addSurfaceLoop(nSurfaceTags, tag);
+					int loopTag = gmsh::model::geo::addSurfaceLoop(nSurfaceTags, tag);
+					Native::Record("geo::addSurfaceLoop", nSurfaceTags, loopTag);
+
+					return loopTag;
 				}
 
 				static array<System::Tuple<int, int>^>^ GetBoundary(int dim, array<System::Tuple<int, int>^>^ tags)
@@ -784,7 +1403,10 @@ namespace GmshCommon {
 				static void ImportShapes(System::String^ fileName, [System::Runtime::InteropServices::Out] array<System::Tuple<int, int>^>^% dimTags, System::Boolean highestDimOnly, System::String^ format)
 				{
 					gmsh::vectorpair outDimTags;
-					gmsh::model::occ::importShapes(msclr::interop::marshal_as<std::string>(fileName), outDimTags, highestDimOnly, msclr::interop::marshal_as<std::string>(format));
+					std::string nFormat = msclr::interop::marshal_as<std::string>(format);
+					gmsh::model::occ::importShapes(msclr::interop::marshal_as<std::string>(fileName), outDimTags, highestDimOnly, nFormat);
+					MeshCache::RecordFile(fileName);
+					Native::Record("occ::importShapes", outDimTags, highestDimOnly, nFormat);
 
 					dimTags = gcnew array<System::Tuple<int, int>^>(outDimTags.size());
 					for (int i = 0; i < outDimTags.size(); ++i)
@@ -803,6 +1425,14 @@ namespace GmshCommon {
 					return dimTags;
 				}
 
+				static void GetEntities(int dim, [System::Runtime::InteropServices::Out] array<DimTag>^% dimTags)
+				{
+					gmsh::vectorpair outDimTags;
+					gmsh::model::occ::getEntities(outDimTags, dim);
+
+					dimTags = Native::ToDimTags(outDimTags);
+				}
+
 				static void Remove(array<System::Tuple<int, int>^>^ dimTags)
 				{
 					Remove(dimTags, false);
@@ -815,11 +1445,22 @@ namespace GmshCommon {
 						udimTags.push_back(std::pair<int, int>(dimTags[i]->Item1, dimTags[i]->Item2));
 
 					gmsh::model::occ::remove(udimTags, recursive);
+					Native::Record("occ::remove", udimTags, static_cast<bool>(recursive));
+				}
+
+				static void Remove(array<DimTag>^ dimTags, System::Boolean recursive)
+				{
+					gmsh::vectorpair udimTags;
+					Native::ToVectorPair(dimTags, udimTags);
+
+					gmsh::model::occ::remove(udimTags, recursive);
+					Native::Record("occ::remove", udimTags, static_cast<bool>(recursive));
 				}
 
 				static void RemoveAllDuplicates()
 				{
 					gmsh::model::occ::removeAllDuplicates();
+					Native::Record("occ::removeAllDuplicates");
 				}
 
 				static void Fragment(
@@ -854,6 +1495,7 @@ namespace GmshCommon {
 						ntoolDimTags.push_back(std::pair<int, int>(toolDimTags[i]->Item1, toolDimTags[i]->Item2));
 
 					gmsh::model::occ::fragment(nobjectDimTags, ntoolDimTags, noutDimTags, noutDimTagsMap, tag, removeObject, removeTool);
+					Native::Record("occ::fragment", nobjectDimTags, ntoolDimTags, tag, static_cast<bool>(removeObject), static_cast<bool>(removeTool));
 
 					outDimTags = gcnew array < System::Tuple<int, int>^>(noutDimTags.size());
 					for (int i = 0; i < noutDimTags.size(); ++i)
@@ -869,6 +1511,20 @@ namespace GmshCommon {
 
 				}
 
+				static void Fragment(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					int tag,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunBoolean(gmsh::model::occ::fragment, "occ::fragment", objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, tag, removeObject, removeTool);
+				}
+
 				static void HealShapes(
 					[System::Runtime::InteropServices::Out] array<System::Tuple<int, int>^>^% outDimTags,
 					array<System::Tuple<int, int>^>^ dimTags,
@@ -881,6 +1537,8 @@ namespace GmshCommon {
 						nDimTags.push_back(std::pair<int, int>(dimTags[i]->Item1, dimTags[i]->Item2));
 
 					gmsh::model::occ::healShapes(noutDimTags, nDimTags, tolerance, fixDegenerate, fixSmallEdges, fixSmallFaces, sewFaces, makeSolids);
+					Native::Record("occ::healShapes", nDimTags, tolerance, static_cast<bool>(fixDegenerate), static_cast<bool>(fixSmallEdges),
+						static_cast<bool>(fixSmallFaces), static_cast<bool>(sewFaces), static_cast<bool>(makeSolids));
 
 					//std::string msg = "Num dim tags: " + std::to_string(nDimTags.size()) + "   num outdimtags: " + std::to_string(noutDimTags.size());
 					//throw gcnew System::Exception(gcnew System::String(msg.c_str()));
@@ -892,6 +1550,37 @@ namespace GmshCommon {
 				}
 
 
+				static void HealShapes(
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					array<DimTag>^ dimTags,
+					double tolerance, System::Boolean fixDegenerate,
+					System::Boolean fixSmallEdges, System::Boolean fixSmallFaces,
+					System::Boolean sewFaces, System::Boolean makeSolids)
+				{
+					gmsh::vectorpair noutDimTags, nDimTags;
+					Native::ToVectorPair(dimTags, nDimTags);
+
+					gmsh::model::occ::healShapes(noutDimTags, nDimTags, tolerance, fixDegenerate, fixSmallEdges, fixSmallFaces, sewFaces, makeSolids);
+					Native::Record("occ::healShapes", nDimTags, tolerance, static_cast<bool>(fixDegenerate), static_cast<bool>(fixSmallEdges),
+						static_cast<bool>(fixSmallFaces), static_cast<bool>(sewFaces), static_cast<bool>(makeSolids));
+
+					outDimTags = Native::ToDimTags(noutDimTags);
+				}
+
+				static void Intersect(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					int tag,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunBoolean(gmsh::model::occ::intersect, "occ::intersect", objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, tag, removeObject, removeTool);
+				}
+
 				static void Intersect(
 					array<System::Tuple<int, int>^>^ objectDimTags,
 					array<System::Tuple<int, int>^>^ toolDimTags,
@@ -912,6 +1601,7 @@ namespace GmshCommon {
 						ntoolDimTags.push_back(std::pair<int, int>(toolDimTags[i]->Item1, toolDimTags[i]->Item2));
 
 					gmsh::model::occ::intersect(nobjectDimTags, ntoolDimTags, noutDimTags, noutDimTagsMap, tag, removeObject, removeTool);
+					Native::Record("occ::intersect", nobjectDimTags, ntoolDimTags, tag, static_cast<bool>(removeObject), static_cast<bool>(removeTool));
 
 					outDimTags = gcnew array < System::Tuple<int, int>^>(noutDimTags.size());
 					for (int i = 0; i < noutDimTags.size(); ++i)
@@ -946,6 +1636,7 @@ namespace GmshCommon {
 						ntoolDimTags.push_back(std::pair<int, int>(toolDimTags[i]->Item1, toolDimTags[i]->Item2));
 
 					gmsh::model::occ::cut(nobjectDimTags, ntoolDimTags, noutDimTags, noutDimTagsMap, tag, removeObject, removeTool);
+					Native::Record("occ::cut", nobjectDimTags, ntoolDimTags, tag, static_cast<bool>(removeObject), static_cast<bool>(removeTool));
 
 					outDimTags = gcnew array < System::Tuple<int, int>^>(noutDimTags.size());
 					for (int i = 0; i < noutDimTags.size(); ++i)
@@ -960,14 +1651,74 @@ namespace GmshCommon {
 					}
 				}
 
+				static void Cut(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					int tag,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunBoolean(gmsh::model::occ::cut, "occ::cut", objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, tag, removeObject, removeTool);
+				}
+
+				// Like Fragment, Intersect and Cut, but the entities are first grouped by
+				// overlapping bounding boxes and the operation runs once per group, so OCC
+				// does not test pairs that cannot touch. The outputs are merged into what
+				// a single call would return.
+				static void FragmentClustered(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunClustered(Native::BooleanKind::Fragment, objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, removeObject, removeTool);
+				}
+
+				static void IntersectClustered(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunClustered(Native::BooleanKind::Intersect, objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, removeObject, removeTool);
+				}
+
+				static void CutClustered(
+					array<DimTag>^ objectDimTags,
+					array<DimTag>^ toolDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTags,
+					[System::Runtime::InteropServices::Out] array<DimTag>^% outDimTagsMap,
+					[System::Runtime::InteropServices::Out] array<int>^% outDimTagsMapOffsets,
+					System::Boolean removeObject,
+					System::Boolean removeTool
+				)
+				{
+					RunClustered(Native::BooleanKind::Cut, objectDimTags, toolDimTags, outDimTags, outDimTagsMap, outDimTagsMapOffsets, removeObject, removeTool);
+				}
+
 				static int AddBox(double x, double y, double z, double dx, double dy, double dz)
 				{
-					return gmsh::model::occ::addBox(x, y, z, dx, dy, dz, -1);
+					return AddBox(x, y, z, dx, dy, dz, -1);
 				}
 
 				static int AddBox(double x, double y, double z, double dx, double dy, double dz, int tag)
 				{
-					return gmsh::model::occ::addBox(x, y, z, dx, dy, dz, tag);
+					int boxTag = gmsh::model::occ::addBox(x, y, z, dx, dy, dz, tag);
+					Native::Record("occ::addBox", x, y, z, dx, dy, dz, boxTag);
+
+					return boxTag;
 				}
 
 				static int AddPoint(double x, double y, double z, int tag)
@@ -982,32 +1733,41 @@ namespace GmshCommon {
 
 				static int AddPoint(double x, double y, double z, double meshSize, int tag)
 				{
-					return gmsh::model::occ::addPoint(x, y, z, meshSize, tag); 
+					int pointTag = gmsh::model::occ::addPoint(x, y, z, meshSize, tag);
+					Native::Record("occ::addPoint", x, y, z, meshSize, pointTag);
+
+					return pointTag;
 				}
 
 				static int AddRectangle(double x, double y, double z, double dx, double dy, int tag, double roundedRadius)
 				{
-					return gmsh::model::occ::addRectangle(x, y, z, dx, dy, tag, roundedRadius);
+					int rectangleTag = gmsh::model::occ::addRectangle(x, y, z, dx, dy, tag, roundedRadius);
+					Native::Record("occ::addRectangle", x, y, z, dx, dy, rectangleTag, roundedRadius);
+
+					return rectangleTag;
 				}
 
 				static int AddRectangle(double x, double y, double z, double dx, double dy, double roundedRadius)
 				{
-					return gmsh::model::occ::addRectangle(x, y, z, dx, dy, -1, roundedRadius);
+					return AddRectangle(x, y, z, dx, dy, -1, roundedRadius);
 				}
 
 				static int AddRectangle(double x, double y, double z, double dx, double dy)
 				{
-					return gmsh::model::occ::addRectangle(x, y, z, dx, dy, -1);
+					return AddRectangle(x, y, z, dx, dy, -1, 0.0);
 				}
 
 				static int AddLine(int startTag, int endTag, int tag)
 				{
-					return gmsh::model::occ::addLine(startTag, endTag, tag);
+					int lineTag = gmsh::model::occ::addLine(startTag, endTag, tag);
+					Native::Record("occ::addLine", startTag, endTag, lineTag);
+
+					return lineTag;
 				}
 
 				static int AddLine(int startTag, int endTag)
 				{
-					return gmsh::model::occ::addLine(startTag, endTag);
+					return AddLine(startTag, endTag, -1);
 				}
 
 				static int AddBSpline(array<int>^ pointTags, int tag, int degree, array<double>^ weights, array<double>^ knots, array<int>^ multiplicities)
@@ -1020,7 +1780,10 @@ namespace GmshCommon {
 					Marshal::Copy(knots, 0, IntPtr(knots_native.data()), knots->Length);
 					Marshal::Copy(multiplicities, 0, IntPtr(multiplicities_native.data()), multiplicities->Length);
 
-					return gmsh::model::occ::addBSpline(pointTags_native, tag, degree, weights_native, knots_native, multiplicities_native);
+					int curveTag = gmsh::model::occ::addBSpline(pointTags_native, tag, degree, weights_native, knots_native, multiplicities_native);
+					Native::Record("occ::addBSpline", pointTags_native, curveTag, degree, weights_native, knots_native, multiplicities_native);
+
+					return curveTag;
 				}
 
 				static int AddBSpline(array<int>^ pointTags, int tag, int degree, array<double>^ weights)
@@ -1031,8 +1794,10 @@ namespace GmshCommon {
 					Marshal::Copy(pointTags, 0, IntPtr(pointTags_native.data()), pointTags->Length);
 					Marshal::Copy(weights, 0, IntPtr(weights_native.data()), weights->Length);
 
+					int curveTag = gmsh::model::occ::addBSpline(pointTags_native, tag, degree, weights_native);
+					Native::Record("occ::addBSpline", pointTags_native, curveTag, degree, weights_native);
 
-					return gmsh::model::occ::addBSpline(pointTags_native, tag, degree, weights_native);
+					return curveTag;
 				}
 
 				static int AddTrimmedSurface(int surfaceTag, array<int>^ wireTags, bool wire3D, int tag)
@@ -1040,7 +1805,10 @@ namespace GmshCommon {
 					std::vector<int> wireTags_native(wireTags->Length);
 					Marshal::Copy(wireTags, 0, IntPtr(wireTags_native.data()), wireTags->Length);
 
-					return gmsh::model::occ::addTrimmedSurface(surfaceTag, wireTags_native, wire3D, tag);
+					int trimmedTag = gmsh::model::occ::addTrimmedSurface(surfaceTag, wireTags_native, wire3D, tag);
+					Native::Record("occ::addTrimmedSurface", surfaceTag, wireTags_native, wire3D, trimmedTag);
+
+					return trimmedTag;
 				}
 
 				static int AddTrimmedSurface(int surfaceTag, array<int>^ wireTags, bool wire3D)
@@ -1075,11 +1843,14 @@ namespace GmshCommon {
 					Marshal::Copy(multiplicitiesV, 0, IntPtr(multiplicitiesV_native.data()), multiplicitiesV->Length);
 					Marshal::Copy(wireTags, 0, IntPtr(wireTags_native.data()), wireTags->Length);
 
-					return gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
+					int surfaceTag = gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
 						knotsU_native, knotsV_native,
 						multiplicitiesU_native, multiplicitiesV_native,
 						wireTags_native, wire3d);
+					Native::Record("occ::addBSplineSurface", pointTags_native, numPointsU, surfaceTag, degreeU, degreeV, weights_native,
+						knotsU_native, knotsV_native, multiplicitiesU_native, multiplicitiesV_native, wireTags_native, wire3d);
 
+					return surfaceTag;
 				}
 
 				static int AddBSplineSurface(
@@ -1100,10 +1871,13 @@ namespace GmshCommon {
 					Marshal::Copy(multiplicitiesU, 0, IntPtr(multiplicitiesU_native.data()), multiplicitiesU->Length);
 					Marshal::Copy(multiplicitiesV, 0, IntPtr(multiplicitiesV_native.data()), multiplicitiesV->Length);
 
-					return gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
+					int surfaceTag = gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
 						knotsU_native, knotsV_native,
 						multiplicitiesU_native, multiplicitiesV_native);
+					Native::Record("occ::addBSplineSurface", pointTags_native, numPointsU, surfaceTag, degreeU, degreeV, weights_native,
+						knotsU_native, knotsV_native, multiplicitiesU_native, multiplicitiesV_native);
 
+					return surfaceTag;
 				}
 
 				static int AddPlaneSurface(array<int>^ wireTags)
@@ -1116,7 +1890,10 @@ namespace GmshCommon {
 					std::vector<int> wireTags_native(wireTags->Length);
 					Marshal::Copy(wireTags, 0, IntPtr(wireTags_native.data()), wireTags->Length);
 
-					return gmsh::model::occ::addPlaneSurface(wireTags_native, tag);
+					int surfaceTag = gmsh::model::occ::addPlaneSurface(wireTags_native, tag);
+					Native::Record("occ::addPlaneSurface", wireTags_native, surfaceTag);
+
+					return surfaceTag;
 				}
 
 				static int AddBSplineSurface(
@@ -1133,10 +1910,14 @@ namespace GmshCommon {
 					Marshal::Copy(weights, 0, IntPtr(weights_native.data()), weights->Length);
 					Marshal::Copy(wireTags, 0, IntPtr(wireTags_native.data()), wireTags->Length);
 
-					return gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
+					int surfaceTag = gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
 						std::vector<double>(), std::vector<double>(),
 						std::vector<int>(), std::vector<int>(),
 						wireTags_native, wire3d);
+					Native::Record("occ::addBSplineSurface", pointTags_native, numPointsU, surfaceTag, degreeU, degreeV, weights_native,
+						wireTags_native, wire3d);
+
+					return surfaceTag;
 				}
 
 				static int AddBSplineSurface(
@@ -1150,19 +1931,28 @@ namespace GmshCommon {
 					Marshal::Copy(pointTags, 0, IntPtr(pointTags_native.data()), pointTags->Length);
 					Marshal::Copy(weights, 0, IntPtr(weights_native.data()), weights->Length);
 
-					return gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
+					int surfaceTag = gmsh::model::occ::addBSplineSurface(pointTags_native, numPointsU, tag, degreeU, degreeV, weights_native,
 						std::vector<double>(), std::vector<double>(),
 						std::vector<int>(), std::vector<int>());
+					Native::Record("occ::addBSplineSurface", pointTags_native, numPointsU, surfaceTag, degreeU, degreeV, weights_native);
+
+					return surfaceTag;
 				}
 
 				static int AddCone(double x, double y, double z, double dx, double dy, double dz, double r1, double r2, int tag, double angle)
 				{
-					return gmsh::model::occ::addCone(x, y, z, dx, dy, dz, r1, r2, tag, angle);
+					int coneTag = gmsh::model::occ::addCone(x, y, z, dx, dy, dz, r1, r2, tag, angle);
+					Native::Record("occ::addCone", x, y, z, dx, dy, dz, r1, r2, coneTag, angle);
+
+					return coneTag;
 				}
 
 				static int AddCone(double x, double y, double z, double dx, double dy, double dz, double r1, double r2)
 				{
-					return gmsh::model::occ::addCone(x, y, z, dx, dy, dz, r1, r2, -1);
+					int coneTag = gmsh::model::occ::addCone(x, y, z, dx, dy, dz, r1, r2, -1);
+					Native::Record("occ::addCone", x, y, z, dx, dy, dz, r1, r2, coneTag);
+
+					return coneTag;
 				}
 
 				static int AddCircle(double x, double y, double z, double r, int tag, double angle1, double angle2, array<double>^ zAxis, array<double>^ xAxis)
@@ -1173,7 +1963,10 @@ namespace GmshCommon {
 					Marshal::Copy(zAxis, 0, IntPtr(zAxis_native.data()), zAxis->Length);
 					Marshal::Copy(xAxis, 0, IntPtr(xAxis_native.data()), xAxis->Length);
 
-					return gmsh::model::occ::addCircle(x, y, z, r, tag, angle1, angle2, zAxis_native, xAxis_native);
+					int circleTag = gmsh::model::occ::addCircle(x, y, z, r, tag, angle1, angle2, zAxis_native, xAxis_native);
+					Native::Record("occ::addCircle", x, y, z, r, circleTag, angle1, angle2, zAxis_native, xAxis_native);
+
+					return circleTag;
 				}
 
 				static int AddCircle(double x, double y, double z, double r, int tag, double angle1, double angle2, array<double>^ zAxis)
@@ -1183,12 +1976,18 @@ namespace GmshCommon {
 					std::vector<double> zAxis_native(3);
 					Marshal::Copy(zAxis, 0, IntPtr(zAxis_native.data()), zAxis->Length);
 
-					return gmsh::model::occ::addCircle(x, y, z, r, tag, angle1, angle2, zAxis_native);
+					int circleTag = gmsh::model::occ::addCircle(x, y, z, r, tag, angle1, angle2, zAxis_native);
+					Native::Record("occ::addCircle", x, y, z, r, circleTag, angle1, angle2, zAxis_native);
+
+					return circleTag;
 				}
 
 				static int AddCircle(double x, double y, double z, double r)
 				{
-					return gmsh::model::occ::addCircle(x, y, z, r);
+					int circleTag = gmsh::model::occ::addCircle(x, y, z, r);
+					Native::Record("occ::addCircle", x, y, z, r, circleTag);
+
+					return circleTag;
 				}
 
 				static array < System::Tuple<int, int>^>^ Extrude(array<double>^ dimTags, double dx, double dy, double dz)
@@ -1197,6 +1996,7 @@ namespace GmshCommon {
 					Marshal::Copy(dimTags, 0, IntPtr(dimTags_native.data()), dimTags->Length);
 
 					gmsh::model::occ::extrude(dimTags_native, dx, dy, dz, outDimTags_native);
+					Native::Record("occ::extrude", dimTags_native, dx, dy, dz);
 
 					array < System::Tuple<int, int>^>^ outDimTags = gcnew array < System::Tuple<int, int>^>(outDimTags_native.size());
 
@@ -1211,7 +2011,10 @@ namespace GmshCommon {
 					std::vector<int> curveTags_native(curveTags->Length);
 					Marshal::Copy(curveTags, 0, IntPtr(curveTags_native.data()), curveTags->Length);
 
-					return gmsh::model::occ::addWire(curveTags_native, tag, checkClosed);
+					int wireTag = gmsh::model::occ::addWire(curveTags_native, tag, checkClosed);
+					Native::Record("occ::addWire", curveTags_native, wireTag, checkClosed);
+
+					return wireTag;
 				}
 
 				static int AddSurfaceLoop(array<int>^ surfaceTags)
@@ -1224,7 +2027,10 @@ namespace GmshCommon {
 					std::vector<int> nSurfaceTags(surfaceTags->Length);
 					Marshal::Copy(surfaceTags, 0, IntPtr(nSurfaceTags.data()), surfaceTags->Length);
 
-					return gmsh::model::occ::addSurfaceLoop(nSurfaceTags, tag);
+					int loopTag = gmsh::model::occ::addSurfaceLoop(nSurfaceTags, tag);
+					Native::Record("occ::addSurfaceLoop", nSurfaceTags, loopTag);
+
+					return loopTag;
 				}
 
 				static int AddVolume(array<int>^ shellTags)
@@ -1237,7 +2043,90 @@ namespace GmshCommon {
 					std::vector<int> nShellTags(shellTags->Length);
 					Marshal::Copy(shellTags, 0, IntPtr(nShellTags.data()), shellTags->Length);
 
-					return gmsh::model::occ::addVolume(nShellTags, tag);
+					int volumeTag = gmsh::model::occ::addVolume(nShellTags, tag);
+					Native::Record("occ::addVolume", nShellTags, volumeTag);
+
+					return volumeTag;
+				}
+
+				// Builds all of 'brep' in one call and synchronizes once, instead of once
+				// per entity. If 'solid', the faces are closed into a volume, whose tag is
+				// returned (-1 otherwise). If 'heal', the result is healed with 'tolerance'.
+				static int AddBrep(BrepDescription^ brep, bool solid, bool heal, double tolerance, [System::Runtime::InteropServices::Out] array<int>^% faceTags)
+				{
+					if (brep == nullptr) throw gcnew System::ArgumentNullException("brep");
+
+					Native::BrepArrays nBrep;
+					brep->ToNative(nBrep);
+
+					Native::BrepResult result;
+					try
+					{
+						Native::BuildBrep(nBrep, solid, heal, tolerance, result);
+					}
+					catch (const std::invalid_argument& e)
+					{
+						throw gcnew System::ArgumentException(gcnew System::String(e.what()), "brep");
+					}
+
+					Native::Record("occ::addBrep",
+						nBrep.curveDegrees, nBrep.curvePointOffsets, nBrep.curvePoints, nBrep.curveWeights,
+						nBrep.curveKnotOffsets, nBrep.curveKnots, nBrep.curveMultiplicities,
+						nBrep.vertexPoints, nBrep.curveVertices,
+						nBrep.surfaceDegrees, nBrep.surfacePointsU, nBrep.surfacePointOffsets, nBrep.surfacePoints, nBrep.surfaceWeights,
+						nBrep.surfaceKnotOffsets, nBrep.surfaceKnots, nBrep.surfaceMultiplicities,
+						nBrep.loopOffsets, nBrep.loopCurves, nBrep.faceSurfaces, nBrep.faceLoopOffsets, nBrep.faceLoops,
+						nBrep.wire3D, solid, heal, tolerance);
+
+					faceTags = gcnew array<int>(static_cast<int>(result.faceTags.size()));
+					if (faceTags->Length > 0)
+						Marshal::Copy(IntPtr(result.faceTags.data()), faceTags, 0, faceTags->Length);
+
+					return result.volumeTag;
+				}
+
+				static int AddBrep(BrepDescription^ brep, bool solid, bool heal, [System::Runtime::InteropServices::Out] array<int>^% faceTags)
+				{
+					return AddBrep(brep, solid, heal, 1e-6, faceTags);
+				}
+
+			private:
+				typedef void (*BooleanOperation)(const gmsh::vectorpair&, const gmsh::vectorpair&, gmsh::vectorpair&, std::vector<gmsh::vectorpair>&, const int, const bool, const bool);
+
+				static void RunBoolean(BooleanOperation operation, const char* name,
+					array<DimTag>^ objectDimTags, array<DimTag>^ toolDimTags,
+					array<DimTag>^% outDimTags, array<DimTag>^% outDimTagsMap, array<int>^% outDimTagsMapOffsets,
+					int tag, bool removeObject, bool removeTool)
+				{
+					gmsh::vectorpair noutDimTags, nobjectDimTags, ntoolDimTags;
+					std::vector<gmsh::vectorpair> noutDimTagsMap;
+
+					Native::ToVectorPair(objectDimTags, nobjectDimTags);
+					Native::ToVectorPair(toolDimTags, ntoolDimTags);
+
+					operation(nobjectDimTags, ntoolDimTags, noutDimTags, noutDimTagsMap, tag, removeObject, removeTool);
+					Native::Record(name, nobjectDimTags, ntoolDimTags, tag, removeObject, removeTool);
+
+					outDimTags = Native::ToDimTags(noutDimTags);
+					Native::ToDimTagsMap(noutDimTagsMap, outDimTagsMap, outDimTagsMapOffsets);
+				}
+
+				static void RunClustered(Native::BooleanKind kind,
+					array<DimTag>^ objectDimTags, array<DimTag>^ toolDimTags,
+					array<DimTag>^% outDimTags, array<DimTag>^% outDimTagsMap, array<int>^% outDimTagsMapOffsets,
+					bool removeObject, bool removeTool)
+				{
+					gmsh::vectorpair noutDimTags, nobjectDimTags, ntoolDimTags;
+					std::vector<gmsh::vectorpair> noutDimTagsMap;
+
+					Native::ToVectorPair(objectDimTags, nobjectDimTags);
+					Native::ToVectorPair(toolDimTags, ntoolDimTags);
+
+					Native::RunClustered(kind, nobjectDimTags, ntoolDimTags, noutDimTags, noutDimTagsMap, -1, removeObject, removeTool);
+					Native::Record("occ::clusteredBoolean", kind, nobjectDimTags, ntoolDimTags, removeObject, removeTool);
+
+					outDimTags = Native::ToDimTags(noutDimTags);
+					Native::ToDimTagsMap(noutDimTagsMap, outDimTagsMap, outDimTagsMapOffsets);
 				}
 			};
 
@@ -1252,7 +2141,11 @@ namespace GmshCommon {
 
 				int Add(System::String^ fieldName, int tag)
 				{
-					return gmsh::model::mesh::field::add(msclr::interop::marshal_as<std::string>(fieldName), tag);
+					std::string nType = msclr::interop::marshal_as<std::string>(fieldName);
+					int fieldTag = gmsh::model::mesh::field::add(nType, tag);
+					Native::Record("field::add", nType, fieldTag);
+
+					return fieldTag;
 				}
 
 				double GetNumber(int tag, System::String^ option)
@@ -1301,21 +2194,26 @@ namespace GmshCommon {
 				void Remove(int tag)
 				{
 					gmsh::model::mesh::field::remove(tag);
+					Native::Record("field::remove", tag);
 				}
 
 				void SetAsBackgroundMesh(int tag)
 				{
 					gmsh::model::mesh::field::setAsBackgroundMesh(tag);
+					Native::Record("field::setAsBackgroundMesh", tag);
 				}
 
 				void SetAsBoundaryLayer(int tag)
 				{
 					gmsh::model::mesh::field::setAsBoundaryLayer(tag);
+					Native::Record("field::setAsBoundaryLayer", tag);
 				}
 
 				void SetNumber(int tag, System::String^ option, double value)
 				{
-					gmsh::model::mesh::field::setNumber(tag, msclr::interop::marshal_as<std::string>(option), value);
+					std::string nOption = msclr::interop::marshal_as<std::string>(option);
+					gmsh::model::mesh::field::setNumber(tag, nOption, value);
+					Native::Record("field::setNumber", tag, nOption, value);
 				}
 
 				void SetNumbers(int tag, System::String^ option, array<double>^ values)
@@ -1323,12 +2221,16 @@ namespace GmshCommon {
 					std::vector<double> nValues(values->Length);
 					Marshal::Copy(values, 0, IntPtr(nValues.data()), values->Length);
 
-					gmsh::model::mesh::field::setNumbers(tag, msclr::interop::marshal_as<std::string>(option), nValues);
+					std::string nOption = msclr::interop::marshal_as<std::string>(option);
+					gmsh::model::mesh::field::setNumbers(tag, nOption, nValues);
+					Native::Record("field::setNumbers", tag, nOption, nValues);
 				}
 
 				void SetString(int tag, System::String^ option, System::String^ value)
 				{
-					gmsh::model::mesh::field::setString(tag, msclr::interop::marshal_as<std::string>(option), msclr::interop::marshal_as<std::string>(value));
+					std::string nOption = msclr::interop::marshal_as<std::string>(option), nValue = msclr::interop::marshal_as<std::string>(value);
+					gmsh::model::mesh::field::setString(tag, nOption, nValue);
+					Native::Record("field::setString", tag, nOption, nValue);
 				}
 			};
 		};
@@ -1339,11 +2241,13 @@ namespace GmshCommon {
 			static void SetNumber(System::String^ parameter, double value)
 			{
 				gmsh::option::setNumber(msclr::interop::marshal_as<std::string>(parameter), value);
+				MeshCache::TrackOption(parameter, false);
 			}
 
 			static void SetString(System::String^ parameter, System::String^ value)
 			{
 				gmsh::option::setString(msclr::interop::marshal_as<std::string>(parameter), msclr::interop::marshal_as<std::string>(value));
+				MeshCache::TrackOption(parameter, true);
 			}
 
 			static double GetNumber(System::String^ parameter)
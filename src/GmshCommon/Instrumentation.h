@@ -0,0 +1,241 @@
+#pragma once
+
+#include "gmsh.h"
+#include <string>
+#include <vector>
+#include <msclr\lock.h>
+
+#include "Session.h"
+#include "LogStream.h"
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Bytes held by a set of per-type tag vectors, as reported to Instrumentation.
+		inline long long TagBytes(const std::vector<std::vector<size_t>>& tags)
+		{
+			size_t count = 0;
+			for (const std::vector<size_t>& block : tags)
+				count += block.size();
+			return static_cast<long long>(count * sizeof(size_t));
+		}
+	}
+
+	/// <summary>
+	/// Aggregated cost of one instrumented wrapper method since the last reset:
+	/// wall time, and the bytes it copied between native and managed memory and
+	/// allocated as managed arrays.
+	/// </summary>
+	public ref class CallTiming
+	{
+	public:
+		property System::String^ Name { System::String^ get() { return m_name; } }
+		property int Calls { int get() { return m_calls; } }
+		property double TotalSeconds { double get() { return m_totalSeconds; } }
+		property double MaxSeconds { double get() { return m_maxSeconds; } }
+		property long long BytesCopied { long long get() { return m_bytesCopied; } }
+		property long long ManagedBytes { long long get() { return m_managedBytes; } }
+
+		virtual System::String^ ToString() override
+		{
+			return System::String::Format("{0}: {1} calls, {2:F4} s (max {3:F4} s), {4} bytes copied, {5} bytes allocated",
+				m_name, m_calls, m_totalSeconds, m_maxSeconds, m_bytesCopied, m_managedBytes);
+		}
+
+	internal:
+		CallTiming(System::String^ name) : m_name(name) {}
+
+		void Add(double seconds, long long bytesCopied, long long managedBytes)
+		{
+			++m_calls;
+			m_totalSeconds += seconds;
+			m_maxSeconds = System::Math::Max(m_maxSeconds, seconds);
+			m_bytesCopied += bytesCopied;
+			m_managedBytes += managedBytes;
+		}
+
+		CallTiming^ Copy()
+		{
+			CallTiming^ copy = gcnew CallTiming(m_name);
+			copy->m_calls = m_calls;
+			copy->m_totalSeconds = m_totalSeconds;
+			copy->m_maxSeconds = m_maxSeconds;
+			copy->m_bytesCopied = m_bytesCopied;
+			copy->m_managedBytes = m_managedBytes;
+			return copy;
+		}
+
+	private:
+		System::String^ m_name;
+		int m_calls;
+		double m_totalSeconds, m_maxSeconds;
+		long long m_bytesCopied, m_managedBytes;
+	};
+
+	/// <summary>
+	/// One stage of an instrumented Generate, with the wall time gmsh reported for it
+	/// in its log.
+	/// </summary>
+	public ref class PhaseTiming
+	{
+	public:
+		property LogPhase Phase { LogPhase get() { return m_phase; } }
+		property double Seconds { double get() { return m_seconds; } }
+
+		virtual System::String^ ToString() override
+		{
+			return System::String::Format("{0}: {1:F4} s", m_phase, m_seconds);
+		}
+
+	internal:
+		PhaseTiming(LogPhase phase, double seconds)
+			: m_phase(phase), m_seconds(seconds) {}
+
+	private:
+		LogPhase m_phase;
+		double m_seconds;
+	};
+
+	public ref class InstrumentationSnapshot
+	{
+	public:
+		property array<CallTiming^>^ Calls { array<CallTiming^>^ get() { return m_calls; } }
+		property array<PhaseTiming^>^ Phases { array<PhaseTiming^>^ get() { return m_phases; } }
+
+		// Node and element counts of the mesh after the most recent instrumented
+		// Generate. Elements are surface and volume elements.
+		property long long Nodes { long long get() { return m_nodes; } }
+		property long long Elements { long long get() { return m_elements; } }
+
+		// Duration of the most recent gmsh::initialize through Session.
+		property System::TimeSpan SessionInitialization { System::TimeSpan get() { return m_sessionInitialization; } }
+
+	internal:
+		InstrumentationSnapshot(array<CallTiming^>^ calls, array<PhaseTiming^>^ phases, long long nodes, long long elements,
+			System::TimeSpan sessionInitialization)
+			: m_calls(calls), m_phases(phases), m_nodes(nodes), m_elements(elements), m_sessionInitialization(sessionInitialization) {}
+
+	private:
+		array<CallTiming^>^ m_calls;
+		array<PhaseTiming^>^ m_phases;
+		long long m_nodes, m_elements;
+		System::TimeSpan m_sessionInitialization;
+	};
+
+	// Collects the timings behind Gmsh.Logger.GetInstrumentation. Instrumented methods
+	// take a timestamp with Begin and report with EndCall; both are no-ops while
+	// instrumentation is off.
+	ref class Instrumentation abstract sealed
+	{
+	public:
+		static bool Enabled = false;
+
+		static long long Begin()
+		{
+			return Enabled ? System::Diagnostics::Stopwatch::GetTimestamp() : 0;
+		}
+
+		static void EndCall(System::String^ name, long long start, long long bytesCopied, long long managedBytes)
+		{
+			if (start == 0) return;
+			double seconds = Seconds(start);
+
+			msclr::lock l(s_lock);
+
+			CallTiming^ timing;
+			if (!s_calls->TryGetValue(name, timing))
+			{
+				timing = gcnew CallTiming(name);
+				s_calls->Add(name, timing);
+			}
+
+			timing->Add(seconds, bytesCopied, managedBytes);
+		}
+
+		// Runs a single generate and records the stages gmsh closes in its log with
+		// the wall time it reports for each, then the size of the resulting mesh. The
+		// logger is started for the call unless it already runs; lines an open
+		// LogStream has yet to pump are only read, and left to it.
+		static void Generate(int dim)
+		{
+			bool startLogger = !LogStream::LoggerStarted;
+			if (startLogger) gmsh::logger::start();
+
+			std::vector<std::string> lines;
+			size_t first = 0;
+			try
+			{
+				gmsh::logger::get(lines);
+				first = lines.size();
+
+				gmsh::model::mesh::generate(dim);
+				gmsh::logger::get(lines);
+			}
+			finally
+			{
+				if (startLogger) gmsh::logger::stop();
+			}
+
+			System::Collections::Generic::List<PhaseTiming^>^ phases = gcnew System::Collections::Generic::List<PhaseTiming^>();
+			int phase = Native::PhaseNone;
+			Native::LogRecord record;
+			double seconds;
+			for (size_t i = first; i < lines.size(); ++i)
+			{
+				Native::ParseLogLine(lines[i], phase, record);
+				if (Native::ParseStageTime(record, seconds))
+					phases->Add(gcnew PhaseTiming(static_cast<LogPhase>(record.phase), seconds));
+			}
+
+			double nodes = 0, elements = 0, count = 0;
+			gmsh::option::getNumber("Mesh.NbNodes", nodes);
+
+			const char* elementCounts[] = { "Mesh.NbTriangles", "Mesh.NbQuadrangles", "Mesh.NbTetrahedra",
+				"Mesh.NbHexahedra", "Mesh.NbPrisms", "Mesh.NbPyramids", "Mesh.NbTrihedra" };
+			for (const char* option : elementCounts)
+			{
+				gmsh::option::getNumber(option, count);
+				elements += count;
+			}
+
+			msclr::lock l(s_lock);
+			s_phases->AddRange(phases);
+			s_nodes = static_cast<long long>(nodes);
+			s_elements = static_cast<long long>(elements);
+		}
+
+		static InstrumentationSnapshot^ Snapshot()
+		{
+			msclr::lock l(s_lock);
+
+			array<CallTiming^>^ calls = gcnew array<CallTiming^>(s_calls->Count);
+			int i = 0;
+			for each (CallTiming^ timing in s_calls->Values)
+				calls[i++] = timing->Copy();
+
+			return gcnew InstrumentationSnapshot(calls, s_phases->ToArray(), s_nodes, s_elements, Session::InitializationTime);
+		}
+
+		static void Reset()
+		{
+			msclr::lock l(s_lock);
+			s_calls->Clear();
+			s_phases->Clear();
+			s_nodes = 0;
+			s_elements = 0;
+		}
+
+	private:
+		static double Seconds(long long start)
+		{
+			return static_cast<double>(System::Diagnostics::Stopwatch::GetTimestamp() - start) / System::Diagnostics::Stopwatch::Frequency;
+		}
+
+		static System::Object^ s_lock = gcnew System::Object();
+		static System::Collections::Generic::SortedDictionary<System::String^, CallTiming^>^ s_calls =
+			gcnew System::Collections::Generic::SortedDictionary<System::String^, CallTiming^>(System::StringComparer::Ordinal);
+		static System::Collections::Generic::List<PhaseTiming^>^ s_phases = gcnew System::Collections::Generic::List<PhaseTiming^>();
+		static long long s_nodes, s_elements;
+	};
+}
@@ -0,0 +1,206 @@
+// Compiled as native code: <atomic> is not available under /clr.
+#include "LogRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "gmsh.h"
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			bool StartsWith(const std::string& text, size_t pos, const char* prefix)
+			{
+				return text.compare(pos, std::char_traits<char>::length(prefix), prefix) == 0;
+			}
+
+			int ParseLevel(const std::string& level)
+			{
+				if (level == "Error") return LogError;
+				if (level == "Warning") return LogWarning;
+				if (level == "Progress") return LogProgress;
+				if (level == "Debug") return LogDebug;
+				return LogInfo;
+			}
+
+			// Parses "[ NN%]" at 'pos', moving 'pos' past it and any following spaces.
+			int ParseProgress(const std::string& text, size_t& pos)
+			{
+				if (pos >= text.size() || text[pos] != '[') return -1;
+
+				size_t i = pos + 1;
+				while (i < text.size() && text[i] == ' ') ++i;
+
+				int value = 0;
+				size_t digits = i;
+				while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+					value = value * 10 + (text[i++] - '0');
+
+				if (i == digits || !StartsWith(text, i, "%]")) return -1;
+
+				pos = i + 2;
+				while (pos < text.size() && text[pos] == ' ') ++pos;
+				return value;
+			}
+
+			// The percentage at the end of a progress meter line ("... 40%"), or -1.
+			int TrailingPercentage(const std::string& text)
+			{
+				size_t end = text.find_last_not_of(' ');
+				if (end == std::string::npos || end == 0 || text[end] != '%') return -1;
+
+				size_t begin = end;
+				while (begin > 0 && text[begin - 1] >= '0' && text[begin - 1] <= '9') --begin;
+				if (begin == end) return -1;
+
+				return std::stoi(text.substr(begin, end - begin));
+			}
+		}
+
+		void ParseLogLine(const std::string& line, int& phase, LogRecord& record)
+		{
+			size_t pos = line.find(": ");
+			record.level = ParseLevel(pos == std::string::npos ? std::string() : line.substr(0, pos));
+			pos = pos == std::string::npos ? 0 : pos + 2;
+
+			record.progress = ParseProgress(line, pos);
+			record.message.assign(line, pos, std::string::npos);
+
+			if (record.progress < 0 && record.level == LogProgress)
+				record.progress = TrailingPercentage(record.message);
+
+			if (StartsWith(record.message, 0, "Meshing 1D")) phase = PhaseMesh1D;
+			else if (StartsWith(record.message, 0, "Meshing 2D")) phase = PhaseMesh2D;
+			else if (StartsWith(record.message, 0, "Meshing 3D")) phase = PhaseMesh3D;
+			else if (StartsWith(record.message, 0, "Optimizing")) phase = PhaseOptimize;
+
+			record.phase = phase;
+
+			// The closing line belongs to the stage it closes
+			if (StartsWith(record.message, 0, "Done meshing") || StartsWith(record.message, 0, "Done optimizing"))
+				phase = PhaseNone;
+		}
+
+		bool ParseStageTime(const LogRecord& record, double& seconds)
+		{
+			if (!StartsWith(record.message, 0, "Done meshing") && !StartsWith(record.message, 0, "Done optimizing"))
+				return false;
+
+			size_t pos = record.message.find("(Wall ");
+			if (pos == std::string::npos) return false;
+
+			const char* begin = record.message.c_str() + pos + 6;
+			char* end = nullptr;
+			seconds = std::strtod(begin, &end);
+			return end != begin;
+		}
+
+		struct LogRing::State
+		{
+			explicit State(size_t capacity)
+				: slots(capacity), mask(capacity - 1), head(0), tail(0), dropped(0), progress(-1),
+				phase(PhaseNone), start(std::chrono::steady_clock::now()) {}
+
+			std::vector<LogRecord> slots;
+			size_t mask;
+
+			// Written by the producer and the consumer respectively; kept on separate
+			// cache lines so that the two sides do not contend.
+			std::atomic<size_t> head;
+			char padHead[64];
+			std::atomic<size_t> tail;
+			char padTail[64];
+
+			std::atomic<size_t> dropped;
+			std::atomic<int> progress;
+
+			// Producer only
+			int phase;
+			std::chrono::steady_clock::time_point start;
+			std::vector<std::string> lines;
+		};
+
+		LogRing::LogRing(size_t capacity)
+		{
+			size_t rounded = 1;
+			while (rounded < capacity) rounded <<= 1;
+
+			m_state = new State(rounded);
+		}
+
+		LogRing::~LogRing()
+		{
+			delete m_state;
+		}
+
+		size_t LogRing::Pump()
+		{
+			State& s = *m_state;
+
+			s.lines.clear();
+			gmsh::logger::get(s.lines);
+			if (s.lines.empty()) return 0;
+
+			// Nothing is logged between get and the restart, as both run on this thread
+			gmsh::logger::stop();
+			gmsh::logger::start();
+
+			double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - s.start).count();
+
+			size_t queued = 0;
+			for (const std::string& line : s.lines)
+			{
+				LogRecord record;
+				ParseLogLine(line, s.phase, record);
+				record.time = time;
+
+				if (record.progress >= 0)
+					s.progress.store(record.progress, std::memory_order_relaxed);
+
+				// The last quarter of the queue is kept for warnings and errors, which
+				// usually come at the end of a run and matter most
+				size_t head = s.head.load(std::memory_order_relaxed);
+				size_t used = head - s.tail.load(std::memory_order_acquire);
+				size_t limit = record.level >= LogWarning ? s.mask + 1 : s.mask + 1 - (s.mask + 1) / 4;
+				if (used >= limit)
+				{
+					s.dropped.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+
+				s.slots[head & s.mask] = std::move(record);
+				s.head.store(head + 1, std::memory_order_release);
+				++queued;
+			}
+
+			return queued;
+		}
+
+		bool LogRing::Pop(LogRecord& record)
+		{
+			State& s = *m_state;
+
+			size_t tail = s.tail.load(std::memory_order_relaxed);
+			if (tail == s.head.load(std::memory_order_acquire)) return false;
+
+			record = std::move(s.slots[tail & s.mask]);
+			s.tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		size_t LogRing::Dropped() const
+		{
+			return m_state->dropped.load(std::memory_order_relaxed);
+		}
+
+		int LogRing::Progress() const
+		{
+			return m_state->progress.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		enum LogLevel { LogDebug, LogInfo, LogProgress, LogWarning, LogError };
+		enum LogPhase { PhaseNone, PhaseMesh1D, PhaseMesh2D, PhaseMesh3D, PhaseOptimize };
+
+		struct LogRecord
+		{
+			int level;
+			int phase;
+			int progress;
+			double time;
+			std::string message;
+		};
+
+		// Parses one line of the gmsh logger ("Level: message"). The level and a leading
+		// "[ NN%]" are split off the message; 'phase' tracks the meshing stage across
+		// lines and is updated from the "Meshing nD...", "Optimizing..." and "Done ..."
+		// messages. progress is -1 where gmsh reports none.
+		void ParseLogLine(const std::string& line, int& phase, LogRecord& record);
+
+		// The wall time gmsh reports when it closes a stage ("Done meshing 2D (Wall
+		// 0.0123s, CPU 0.01s)"). False for any other record.
+		bool ParseStageTime(const LogRecord& record, double& seconds);
+
+		// Bounded single-producer, single-consumer queue of parsed log records, fed
+		// from the gmsh logger. Pump runs on the thread that uses gmsh; Pop may run on
+		// one other thread, without locks. Records that arrive while the queue is full
+		// are dropped and counted; once it is three quarters full only warnings and
+		// errors are still queued. Compiled as native code, as <atomic> is not
+		// available under /clr.
+		class LogRing
+		{
+		public:
+			// 'capacity' is rounded up to a power of two.
+			explicit LogRing(size_t capacity);
+			~LogRing();
+
+			LogRing(const LogRing&) = delete;
+			LogRing& operator=(const LogRing&) = delete;
+
+			// Moves the lines logged since the last call into the queue and restarts the
+			// gmsh logger, so its history stays short. Returns the number queued.
+			size_t Pump();
+
+			bool Pop(LogRecord& record);
+
+			size_t Dropped() const;
+
+			// The last progress percentage seen, or -1.
+			int Progress() const;
+
+		private:
+			struct State;
+			State* m_state;
+		};
+	}
+}
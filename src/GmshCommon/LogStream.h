@@ -0,0 +1,180 @@
+#pragma once
+
+#include "gmsh.h"
+#include <msclr\lock.h>
+
+#include "LogRing.h"
+
+namespace GmshCommon {
+
+	public enum class LogLevel { Debug, Info, Progress, Warning, Error };
+
+	// The meshing stage a log entry was written in.
+	public enum class LogPhase { None, Mesh1D, Mesh2D, Mesh3D, Optimize };
+
+	public value struct LogEntry
+	{
+		LogLevel Level;
+		LogPhase Phase;
+
+		// Percentage reported by gmsh with the message, or -1.
+		int Progress;
+
+		// Seconds since the stream was opened, as of the Pump that picked the entry up.
+		double Time;
+
+		System::String^ Message;
+
+		virtual System::String^ ToString() override
+		{
+			return System::String::Format("{0:F3} {1}: {2}", Time, Level, Message);
+		}
+	};
+
+	/// <summary>
+	/// Parsed gmsh log entries, delivered incrementally instead of as the whole
+	/// history. While a stream is open it owns the gmsh logger: Pump moves the new
+	/// lines into a bounded lock-free queue and restarts the logger, so the log does
+	/// not grow. Generate pumps once it is done. Opening a stream does not change
+	/// how Generate meshes. Pump must be called from the thread that uses gmsh; one
+	/// other thread may read entries at the same time.
+	/// </summary>
+	public ref class LogStream : System::IDisposable
+	{
+	public:
+		// Starts the gmsh logger and makes this the open stream. At most 'capacity'
+		// entries are held between reads; later ones are dropped and counted. The
+		// last quarter is kept for warnings and errors. A stream that was never
+		// disposed stops being the open one once it has been collected.
+		static LogStream^ Open(int capacity)
+		{
+			if (capacity < 1) throw gcnew System::ArgumentOutOfRangeException("capacity");
+
+			msclr::lock l(s_lock);
+			if (Active != nullptr) throw gcnew System::InvalidOperationException("A LogStream is already open.");
+
+			// Restarting discards anything a previously started logger has collected
+			gmsh::logger::start();
+			gmsh::logger::stop();
+			gmsh::logger::start();
+			LoggerStarted = true;
+
+			LogStream^ stream = gcnew LogStream(capacity);
+			s_active = gcnew System::WeakReference(stream);
+			return stream;
+		}
+
+		static LogStream^ Open()
+		{
+			return Open(65536);
+		}
+
+		~LogStream()
+		{
+			msclr::lock l(s_lock);
+			if (Active == this)
+			{
+				gmsh::logger::stop();
+				LoggerStarted = false;
+				s_active = nullptr;
+			}
+
+			this->!LogStream();
+		}
+
+		// Leaves the logger running: gmsh is not called from the finalizer thread, and
+		// the next Open restarts it.
+		!LogStream()
+		{
+			delete m_ring;
+			m_ring = nullptr;
+		}
+
+		// Number of entries queued since the last call.
+		int Pump()
+		{
+			return static_cast<int>(Ring->Pump());
+		}
+
+		bool TryRead([System::Runtime::InteropServices::Out] LogEntry% entry)
+		{
+			Native::LogRecord record;
+			if (!Ring->Pop(record)) return false;
+
+			entry.Level = static_cast<LogLevel>(record.level);
+			entry.Phase = static_cast<LogPhase>(record.phase);
+			entry.Progress = record.progress;
+			entry.Time = record.time;
+			entry.Message = gcnew System::String(record.message.c_str());
+			return true;
+		}
+
+		// Adds the queued entries to 'entries' and returns how many there were.
+		int Drain(System::Collections::Generic::ICollection<LogEntry>^ entries)
+		{
+			if (entries == nullptr) throw gcnew System::ArgumentNullException("entries");
+
+			int count = 0;
+			LogEntry entry;
+			while (TryRead(entry))
+			{
+				entries->Add(entry);
+				++count;
+			}
+
+			return count;
+		}
+
+		property long long Dropped
+		{
+			long long get() { return static_cast<long long>(Ring->Dropped()); }
+		}
+
+		// The last percentage gmsh reported, or -1.
+		property int Progress
+		{
+			int get() { return Ring->Progress(); }
+		}
+
+	internal:
+		// Whether the gmsh logger was started through Logger.Start or an open stream.
+		static bool LoggerStarted = false;
+
+		// Pumps the open stream, if any.
+		static void PumpOpen()
+		{
+			LogStream^ stream = Active;
+			if (stream != nullptr && stream->m_ring != nullptr)
+				stream->m_ring->Pump();
+		}
+
+	private:
+		LogStream(int capacity)
+		{
+			m_ring = new Native::LogRing(static_cast<size_t>(capacity));
+		}
+
+		static property LogStream^ Active
+		{
+			LogStream^ get()
+			{
+				System::WeakReference^ active = s_active;
+				return active == nullptr ? nullptr : safe_cast<LogStream^>(active->Target);
+			}
+		}
+
+		property Native::LogRing* Ring
+		{
+			Native::LogRing* get()
+			{
+				if (m_ring == nullptr) throw gcnew System::ObjectDisposedException("LogStream");
+				return m_ring;
+			}
+		}
+
+		Native::LogRing* m_ring;
+
+		static System::Object^ s_lock = gcnew System::Object();
+		static System::WeakReference^ s_active;	// Short, so cleared before the stream is finalized
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gmsh.h"
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// The elements of one type on entity 'tag' (all entities if tag < 0) as a
+		// self-contained block: the coordinates of the nodes they use, compacted to xyz
+		// triplets, and their connectivity as zero-based indices into those.
+		struct MeshBlock
+		{
+			std::vector<size_t> elementTags;
+			std::vector<size_t> nodeTags;
+			std::vector<double> coords;
+			std::vector<int> connectivity;
+		};
+
+		inline void GetMeshBlock(int elementType, int tag, MeshBlock& block)
+		{
+			std::vector<size_t> elementNodes;
+			gmsh::model::mesh::getElementsByType(elementType, block.elementTags, elementNodes, tag);
+
+			size_t maxNodeTag = 0;
+			gmsh::model::mesh::getMaxNodeTag(maxNodeTag);
+
+			std::vector<int> index(maxNodeTag + 1, -1);
+			block.connectivity.resize(elementNodes.size());
+			block.nodeTags.clear();
+			for (size_t i = 0; i < elementNodes.size(); ++i)
+			{
+				int& j = index[elementNodes[i]];
+				if (j < 0)
+				{
+					j = static_cast<int>(block.nodeTags.size());
+					block.nodeTags.push_back(elementNodes[i]);
+				}
+				block.connectivity[i] = j;
+			}
+
+			std::vector<size_t> nodeTags;
+			std::vector<double> coord, parametricCoord;
+			gmsh::model::mesh::getNodes(nodeTags, coord, parametricCoord, -1, -1, false, false);
+
+			block.coords.resize(block.nodeTags.size() * 3);
+			for (size_t i = 0; i < nodeTags.size(); ++i)
+			{
+				int j = index[nodeTags[i]];
+				if (j < 0) continue;
+
+				block.coords[j * 3] = coord[i * 3];
+				block.coords[j * 3 + 1] = coord[i * 3 + 1];
+				block.coords[j * 3 + 2] = coord[i * 3 + 2];
+			}
+		}
+	}
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "gmsh.h"
+#include "ContentHash.h"
+#include <string>
+#include <vector>
+#include <msclr\marshal_cppstd.h>
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Opt-in disk cache for Model.Generate. The key hashes the inputs recorded by
+	/// the wrapper since the model was last cleared (node and element data, the OCC
+	/// and Geo builders, booleans and removals, field definitions and opened, merged
+	/// or imported files), every option set through Option (at its current value),
+	/// and the dimension and bounding box of each model entity. On a hit the binary
+	/// MSH 4.1 file saved by an earlier run is merged instead of meshing again.
+	/// Changes made by calls that are not recorded, such as AddDiscreteEntity or
+	/// RemoveEntities on Model, are only covered by the entities' bounding boxes. Generation with a size callback installed is never cached, nor is a
+	/// model switched to with SetCurrent, until it is next cleared.
+	/// </summary>
+	public ref class MeshCache abstract sealed
+	{
+	public:
+		static property bool Enabled
+		{
+			bool get() { return s_enabled; }
+			void set(bool value) { s_enabled = value; }
+		}
+
+		// Defaults to %LOCALAPPDATA%\GmshCommon\MeshCache.
+		static property System::String^ Directory
+		{
+			System::String^ get()
+			{
+				if (s_directory == nullptr)
+					s_directory = System::IO::Path::Combine(
+						System::Environment::GetFolderPath(System::Environment::SpecialFolder::LocalApplicationData),
+						"GmshCommon", "MeshCache");
+				return s_directory;
+			}
+			void set(System::String^ value) { s_directory = value; }
+		}
+
+		// Limits enforced after each store; the least recently used entries go first.
+		static property long long MaxBytes
+		{
+			long long get() { return s_maxBytes; }
+			void set(long long value)
+			{
+				if (value < 0) throw gcnew System::ArgumentOutOfRangeException("value");
+				s_maxBytes = value;
+			}
+		}
+
+		static property int MaxEntries
+		{
+			int get() { return s_maxEntries; }
+			void set(int value)
+			{
+				if (value < 0) throw gcnew System::ArgumentOutOfRangeException("value");
+				s_maxEntries = value;
+			}
+		}
+
+		static property long long Hits
+		{
+			long long get() { return s_hits; }
+		}
+
+		static property long long Misses
+		{
+			long long get() { return s_misses; }
+		}
+
+		static property long long Evictions
+		{
+			long long get() { return s_evictions; }
+		}
+
+		static void ResetCounters()
+		{
+			s_hits = s_misses = s_evictions = 0;
+		}
+
+		// The key Generate(dim) would look up for the current model.
+		static System::String^ GetKey(int dim)
+		{
+			return gcnew System::String(ComputeKey(dim).c_str());
+		}
+
+		// Forgets the recorded inputs. Called whenever the model is cleared or replaced.
+		static void ResetInputs()
+		{
+			Native::InputHash().Reset();
+			s_untracked = false;
+		}
+
+		// Deletes every cache entry.
+		static void Purge()
+		{
+			array<System::IO::FileInfo^>^ files = GetEntries();
+			for (int i = 0; i < files->Length; ++i)
+				files[i]->Delete();
+		}
+
+	internal:
+		// Merges the cached mesh for (model, dim) if there is one. On a miss the key is
+		// kept for the Store that follows generation.
+		static bool TryLoad(int dim)
+		{
+			s_pendingKey = nullptr;
+			if (!s_enabled || s_sizeCallback || s_untracked) return false;
+
+			System::String^ key = GetKey(dim);
+			System::String^ path = GetPath(key);
+
+			if (System::IO::File::Exists(path))
+			{
+				try
+				{
+					gmsh::model::mesh::clear();
+					gmsh::merge(msclr::interop::marshal_as<std::string>(path));
+					System::IO::File::SetLastWriteTimeUtc(path, System::DateTime::UtcNow);
+
+					++s_hits;
+					return true;
+				}
+				catch (...)
+				{
+					// Unreadable entry: drop it and generate as usual
+					gmsh::model::mesh::clear();
+					try { System::IO::File::Delete(path); }
+					catch (System::Exception^) {}
+				}
+			}
+
+			++s_misses;
+			s_pendingKey = key;
+			return false;
+		}
+
+		static void Store()
+		{
+			System::String^ key = s_pendingKey;
+			s_pendingKey = nullptr;
+			if (key == nullptr || !s_enabled) return;
+
+			System::String^ path = GetPath(key);
+			System::String^ temp = GetPath(key + "." + System::Guid::NewGuid().ToString("N"));
+
+			try
+			{
+				System::IO::Directory::CreateDirectory(Directory);
+				WriteBinary(temp);
+
+				if (System::IO::File::Exists(path))
+					System::IO::File::Delete(temp);
+				else
+					System::IO::File::Move(temp, path);
+
+				Trim();
+			}
+			catch (...)
+			{
+				// A failed store only costs the next run a cache miss
+				try { System::IO::File::Delete(temp); }
+				catch (System::Exception^) {}
+			}
+		}
+
+		// The current model holds content the recorded inputs do not describe, such as
+		// a model switched to from another one. The cache is bypassed until the next
+		// ResetInputs.
+		static void InvalidateInputs()
+		{
+			Native::InputHash().Reset();
+			s_untracked = true;
+		}
+
+		// Adds the content of a file read into the model to the inputs. While the cache
+		// is off the file is not read, and the model is left uncached instead.
+		static void RecordFile(System::String^ path)
+		{
+			if (!s_enabled)
+			{
+				s_untracked = true;
+				return;
+			}
+
+			try
+			{
+				System::IO::FileStream^ stream = System::IO::File::OpenRead(path);
+				try
+				{
+					Native::Record("file", stream->Length);
+
+					array<unsigned char>^ buffer = gcnew array<unsigned char>(1 << 20);
+					int count;
+					while ((count = stream->Read(buffer, 0, buffer->Length)) > 0)
+					{
+						pin_ptr<unsigned char> pinned = &buffer[0];
+						Native::InputHash().Update(pinned, static_cast<size_t>(count));
+					}
+				}
+				finally
+				{
+					delete stream;
+				}
+			}
+			catch (System::Exception^)
+			{
+				s_untracked = true;
+			}
+		}
+
+		static void TrackOption(System::String^ name, bool isString)
+		{
+			(isString ? s_stringOptions : s_numberOptions)->Add(name);
+		}
+
+		// Size callbacks are opaque to the key, so they disable the cache while installed.
+		static void SetSizeCallbackInstalled(bool installed)
+		{
+			s_sizeCallback = installed;
+		}
+
+	private:
+		static std::string ComputeKey(int dim)
+		{
+			Native::ContentHash hash = Native::InputHash();
+			hash.Add(GMSH_API_VERSION);
+			hash.Add(dim);
+
+			gmsh::vectorpair entities;
+			gmsh::model::getEntities(entities);
+
+			hash.Add(entities.size());
+			for (const std::pair<int, int>& entity : entities)
+			{
+				double box[6];
+				gmsh::model::getBoundingBox(entity.first, entity.second, box[0], box[1], box[2], box[3], box[4], box[5]);
+
+				hash.Add(entity.first);
+				hash.Add(entity.second);
+				hash.Add(box);
+			}
+
+			for each (System::String^ name in s_numberOptions)
+			{
+				std::string nName = msclr::interop::marshal_as<std::string>(name);
+				double value = 0;
+				gmsh::option::getNumber(nName, value);
+
+				hash.Add(nName);
+				hash.Add(value);
+			}
+
+			for each (System::String^ name in s_stringOptions)
+			{
+				std::string nName = msclr::interop::marshal_as<std::string>(name), value;
+				gmsh::option::getString(nName, value);
+
+				hash.Add(nName);
+				hash.Add(value);
+			}
+
+			return hash.Digest();
+		}
+
+		static System::String^ GetPath(System::String^ key)
+		{
+			return System::IO::Path::Combine(Directory, key + ".msh");
+		}
+
+		static array<System::IO::FileInfo^>^ GetEntries()
+		{
+			System::IO::DirectoryInfo^ info = gcnew System::IO::DirectoryInfo(Directory);
+			if (!info->Exists) return gcnew array<System::IO::FileInfo^>(0);
+
+			// Keys are 32 hex digits; anything longer is a store in progress
+			System::Collections::Generic::List<System::IO::FileInfo^>^ entries = gcnew System::Collections::Generic::List<System::IO::FileInfo^>();
+			for each (System::IO::FileInfo^ file in info->GetFiles("*.msh"))
+				if (file->Name->Length == 36)
+					entries->Add(file);
+
+			return entries->ToArray();
+		}
+
+		// Evicts the least recently used entries until both limits hold.
+		static void Trim()
+		{
+			array<System::IO::FileInfo^>^ files = GetEntries();
+			array<System::DateTime>^ lastUse = gcnew array<System::DateTime>(files->Length);
+
+			long long bytes = 0;
+			for (int i = 0; i < files->Length; ++i)
+			{
+				lastUse[i] = files[i]->LastWriteTimeUtc;
+				bytes += files[i]->Length;
+			}
+
+			System::Array::Sort(lastUse, files);
+
+			int count = files->Length;
+			for (int i = 0; i < files->Length && (count > s_maxEntries || bytes > s_maxBytes); ++i)
+			{
+				bytes -= files[i]->Length;
+				--count;
+				files[i]->Delete();
+				++s_evictions;
+			}
+		}
+
+		static void WriteBinary(System::String^ path)
+		{
+			const char* names[] = { "Mesh.Binary", "Mesh.MshFileVersion", "Mesh.SaveAll" };
+			const double values[] = { 1, 4.1, 1 };
+			double saved[3];
+
+			for (int i = 0; i < 3; ++i)
+				gmsh::option::getNumber(names[i], saved[i]);
+
+			try
+			{
+				for (int i = 0; i < 3; ++i)
+					gmsh::option::setNumber(names[i], values[i]);
+
+				gmsh::write(msclr::interop::marshal_as<std::string>(path));
+			}
+			finally
+			{
+				for (int i = 0; i < 3; ++i)
+					gmsh::option::setNumber(names[i], saved[i]);
+			}
+		}
+
+		static bool s_enabled = false;
+		static bool s_sizeCallback = false;
+		static bool s_untracked = false;
+		static System::String^ s_directory;
+		static System::String^ s_pendingKey;
+		static long long s_maxBytes = 1LL << 30;
+		static int s_maxEntries = 256;
+		static long long s_hits = 0;
+		static long long s_misses = 0;
+		static long long s_evictions = 0;
+
+		static System::Collections::Generic::SortedSet<System::String^>^ s_numberOptions =
+			gcnew System::Collections::Generic::SortedSet<System::String^>(System::StringComparer::Ordinal);
+		static System::Collections::Generic::SortedSet<System::String^>^ s_stringOptions =
+			gcnew System::Collections::Generic::SortedSet<System::String^>(System::StringComparer::Ordinal);
+	};
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <stdexcept>
+#include <msclr\marshal_cppstd.h>
+
+#include "FieldGraph.h"
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// A mesh size field setup built up front and installed in one call. Add returns
+	/// a node index, and fields refer to each other through SetField/SetFields by
+	/// node index rather than by tag. Options are marshalled once, when they are set.
+	/// Installing a graph identical to one already in place reuses its fields.
+	/// </summary>
+	public ref class FieldGraph : System::IDisposable
+	{
+	public:
+		FieldGraph()
+		{
+			m_graph = new Native::FieldGraph();
+		}
+
+		~FieldGraph()
+		{
+			if (m_graph != nullptr) m_graph->Release();
+			this->!FieldGraph();
+		}
+
+		// A graph that is never disposed keeps its share of the fields: the registry
+		// is not touched from the finalizer thread.
+		!FieldGraph()
+		{
+			delete m_graph;
+			m_graph = nullptr;
+		}
+
+		property int Count
+		{
+			int get() { return static_cast<int>(Graph->Size()); }
+		}
+
+		int Add(System::String^ fieldType)
+		{
+			return Graph->Add(msclr::interop::marshal_as<std::string>(fieldType));
+		}
+
+		void SetNumber(int node, System::String^ option, double value)
+		{
+			try { Graph->SetNumber(node, msclr::interop::marshal_as<std::string>(option), value); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		void SetNumbers(int node, System::String^ option, array<double>^ values)
+		{
+			std::vector<double> nValues(values->Length);
+			if (values->Length > 0)
+				Marshal::Copy(values, 0, IntPtr(nValues.data()), values->Length);
+
+			try { Graph->SetNumbers(node, msclr::interop::marshal_as<std::string>(option), nValues); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		void SetString(int node, System::String^ option, System::String^ value)
+		{
+			try { Graph->SetString(node, msclr::interop::marshal_as<std::string>(option), msclr::interop::marshal_as<std::string>(value)); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		// Sets 'option' (e.g. "InField") to the tag of the field of node 'field'.
+		void SetField(int node, System::String^ option, int field)
+		{
+			try { Graph->SetField(node, msclr::interop::marshal_as<std::string>(option), field); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		// Sets 'option' (e.g. "FieldsList") to the tags of the fields of 'fields'.
+		void SetFields(int node, System::String^ option, array<int>^ fields)
+		{
+			std::vector<int> nFields(fields->Length);
+			if (fields->Length > 0)
+				Marshal::Copy(fields, 0, IntPtr(nFields.data()), fields->Length);
+
+			try { Graph->SetFields(node, msclr::interop::marshal_as<std::string>(option), nFields); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		void SetAsBackgroundMesh(int node)
+		{
+			try { Graph->SetAsBackgroundMesh(node); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		void SetAsBoundaryLayer(int node)
+		{
+			try { Graph->SetAsBoundaryLayer(node); }
+			catch (const std::out_of_range&) { throw gcnew System::ArgumentOutOfRangeException("node"); }
+		}
+
+		// Creates the fields in the current model, or reuses them if an identical
+		// graph is already installed. Returns true if they were created.
+		bool Install()
+		{
+			try
+			{
+				return Graph->Install();
+			}
+			catch (const std::invalid_argument& e)
+			{
+				throw gcnew System::InvalidOperationException(gcnew System::String(e.what()));
+			}
+		}
+
+		// The field tag of 'node' from the last Install.
+		int GetTag(int node)
+		{
+			const std::vector<int>& tags = Graph->Tags();
+			if (node < 0 || static_cast<size_t>(node) >= tags.size())
+				throw gcnew System::ArgumentOutOfRangeException("node");
+
+			return tags[node];
+		}
+
+		// Removes the fields of the last Install from the model, unless another
+		// FieldGraph installed the same content and still uses them.
+		void Remove()
+		{
+			Graph->Remove();
+		}
+
+	private:
+		property Native::FieldGraph* Graph
+		{
+			Native::FieldGraph* get()
+			{
+				if (m_graph == nullptr) throw gcnew System::ObjectDisposedException("FieldGraph");
+				return m_graph;
+			}
+		}
+
+		Native::FieldGraph* m_graph;
+	};
+}
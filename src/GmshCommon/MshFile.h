@@ -0,0 +1,263 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "MshReader.h"
+#include "NativeBuffer.h"
+#include "ElementBlocks.h"
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// A binary MSH 4.1 file read straight into flat buffers, without loading it into
+	/// gmsh. The file is memory-mapped while the MshFile is open: block views point
+	/// into the mapping and are valid until it is disposed; the Get methods copy
+	/// once, from the mapping into the returned buffers.
+	/// </summary>
+	public ref class MshFile : System::IDisposable
+	{
+	public:
+		// Zero-copy view of one $Nodes entity block. Tags are Count size_t values;
+		// coordinates are xyz followed by Dim parametric values if Parametric, so
+		// consecutive nodes are Stride doubles apart. Pointers may be unaligned.
+		value struct NodeBlock
+		{
+			int Dim;
+			int Tag;
+			bool Parametric;
+			long long Count;
+			int Stride;
+			IntPtr Tags;
+			IntPtr Coordinates;
+		};
+
+		// Zero-copy view of one $Elements entity block: Count records of Stride size_t
+		// values, each the element tag followed by NodesPerElement node tags.
+		value struct ElementBlock
+		{
+			int Dim;
+			int Tag;
+			int ElementType;
+			long long Count;
+			int NodesPerElement;
+			int Stride;
+			IntPtr Data;
+		};
+
+		MshFile(System::String^ path)
+		{
+			if (path == nullptr) throw gcnew System::ArgumentNullException("path");
+
+			array<unsigned char>^ utf8 = System::Text::Encoding::UTF8->GetBytes(path);
+			std::string nPath(utf8->Length, '\0');
+			if (utf8->Length > 0)
+				Marshal::Copy(utf8, 0, IntPtr(&nPath[0]), utf8->Length);
+
+			try
+			{
+				m_reader = new Native::MshReader(nPath);
+			}
+			catch (const std::exception& e)
+			{
+				throw gcnew System::IO::IOException(gcnew System::String(e.what()));
+			}
+		}
+
+		~MshFile()
+		{
+			this->!MshFile();
+		}
+
+		!MshFile()
+		{
+			delete m_reader;
+			m_reader = nullptr;
+		}
+
+		property long long NumNodes
+		{
+			long long get() { return static_cast<long long>(Reader->NumNodes()); }
+		}
+
+		property long long NumElements
+		{
+			long long get() { return static_cast<long long>(Reader->NumElements()); }
+		}
+
+		property int NumNodeBlocks
+		{
+			int get() { return static_cast<int>(Reader->NodeBlocks().size()); }
+		}
+
+		property int NumElementBlocks
+		{
+			int get() { return static_cast<int>(Reader->ElementBlocks().size()); }
+		}
+
+		NodeBlock GetNodeBlock(int index)
+		{
+			if (index < 0 || index >= NumNodeBlocks) throw gcnew System::ArgumentOutOfRangeException("index");
+
+			const Native::MshNodeBlock& block = Reader->NodeBlocks()[index];
+
+			NodeBlock view;
+			view.Dim = block.dim;
+			view.Tag = block.tag;
+			view.Parametric = block.parametric;
+			view.Count = static_cast<long long>(block.count);
+			view.Stride = static_cast<int>(block.stride);
+			view.Tags = IntPtr(const_cast<char*>(block.tags));
+			view.Coordinates = IntPtr(const_cast<char*>(block.coords));
+			return view;
+		}
+
+		ElementBlock GetElementBlock(int index)
+		{
+			if (index < 0 || index >= NumElementBlocks) throw gcnew System::ArgumentOutOfRangeException("index");
+
+			const Native::MshElementBlock& block = Reader->ElementBlocks()[index];
+
+			ElementBlock view;
+			view.Dim = block.dim;
+			view.Tag = block.tag;
+			view.ElementType = block.elementType;
+			view.Count = static_cast<long long>(block.count);
+			view.NodesPerElement = static_cast<int>(block.nodesPerElement);
+			view.Stride = static_cast<int>(block.stride);
+			view.Data = IntPtr(const_cast<char*>(block.data));
+			return view;
+		}
+
+		array<int>^ GetElementTypes()
+		{
+			std::vector<int> types = Reader->ElementTypes();
+
+			array<int>^ typesOut = gcnew array<int>(static_cast<int>(types.size()));
+			if (types.size() > 0)
+				Marshal::Copy(IntPtr(types.data()), typesOut, 0, typesOut->Length);
+
+			return typesOut;
+		}
+
+		// All nodes in file order, with coordinates as xyz triplets.
+		void GetNodes([System::Runtime::InteropServices::Out] array<IntPtr>^% nodeTags, [System::Runtime::InteropServices::Out] array<double>^% coord)
+		{
+			size_t numNodes = Reader->NumNodes();
+			nodeTags = gcnew array<IntPtr>(CheckLength(numNodes));
+			coord = gcnew array<double>(CheckLength(3 * numNodes));
+
+			if (numNodes < 1) return;
+
+			pin_ptr<IntPtr> pTags = &nodeTags[0];
+			pin_ptr<double> pCoord = &coord[0];
+			Reader->CopyNodes(reinterpret_cast<size_t*>(static_cast<IntPtr*>(pTags)), pCoord);
+		}
+
+		void GetNodes([System::Runtime::InteropServices::Out] NativeBuffer^% nodeTags, [System::Runtime::InteropServices::Out] NativeBuffer^% coord)
+		{
+			std::vector<size_t> nTags(Reader->NumNodes());
+			std::vector<double> nCoord(3 * nTags.size());
+			Reader->CopyNodes(nTags.data(), nCoord.data());
+
+			nodeTags = Native::Adopt(nTags);
+			coord = Native::Adopt(nCoord);
+		}
+
+		// All elements of 'elementType' in file order, across entities.
+		void GetElementsByType(int elementType, [System::Runtime::InteropServices::Out] array<IntPtr>^% elementTags, [System::Runtime::InteropServices::Out] array<IntPtr>^% nodeTags)
+		{
+			size_t count = Reader->CountElements(elementType);
+			size_t npe = Native::MshNodesPerElement(elementType);
+
+			elementTags = gcnew array<IntPtr>(CheckLength(count));
+			nodeTags = gcnew array<IntPtr>(CheckLength(count * npe));
+
+			if (count < 1) return;
+
+			pin_ptr<IntPtr> pElements = &elementTags[0];
+			pin_ptr<IntPtr> pNodes = &nodeTags[0];
+			Reader->CopyElements(elementType,
+				reinterpret_cast<size_t*>(static_cast<IntPtr*>(pElements)),
+				reinterpret_cast<size_t*>(static_cast<IntPtr*>(pNodes)));
+		}
+
+		void GetElementsByType(int elementType, [System::Runtime::InteropServices::Out] NativeBuffer^% elementTags, [System::Runtime::InteropServices::Out] NativeBuffer^% nodeTags)
+		{
+			size_t count = Reader->CountElements(elementType);
+			std::vector<size_t> nElements(count), nNodes(count * Native::MshNodesPerElement(elementType));
+			Reader->CopyElements(elementType, nElements.data(), nNodes.data());
+
+			elementTags = Native::Adopt(nElements);
+			nodeTags = Native::Adopt(nNodes);
+		}
+
+		// All elements, one block per element type.
+		ElementBlocks^ GetElementBlocks()
+		{
+			std::vector<int> types = Reader->ElementTypes();
+			int numBlocks = static_cast<int>(types.size());
+
+			array<int>^ elementTypes = gcnew array<int>(numBlocks);
+			array<int>^ elementCounts = gcnew array<int>(numBlocks);
+			array<int>^ nodesPerElement = gcnew array<int>(numBlocks);
+
+			size_t numElements = 0, numNodes = 0;
+			for (int i = 0; i < numBlocks; ++i)
+			{
+				size_t count = Reader->CountElements(types[i]);
+				size_t npe = Native::MshNodesPerElement(types[i]);
+
+				elementTypes[i] = types[i];
+				elementCounts[i] = CheckLength(count);
+				nodesPerElement[i] = static_cast<int>(npe);
+
+				numElements += count;
+				numNodes += count * npe;
+			}
+
+			array<IntPtr>^ elementTags = gcnew array<IntPtr>(CheckLength(numElements));
+			array<IntPtr>^ nodeTags = gcnew array<IntPtr>(CheckLength(numNodes));
+
+			if (numElements > 0)
+			{
+				pin_ptr<IntPtr> pElements = &elementTags[0];
+				pin_ptr<IntPtr> pNodes = &nodeTags[0];
+				size_t* elementPtr = reinterpret_cast<size_t*>(static_cast<IntPtr*>(pElements));
+				size_t* nodePtr = reinterpret_cast<size_t*>(static_cast<IntPtr*>(pNodes));
+
+				for (int i = 0; i < numBlocks; ++i)
+				{
+					Reader->CopyElements(types[i], elementPtr, nodePtr);
+					elementPtr += elementCounts[i];
+					nodePtr += static_cast<size_t>(elementCounts[i]) * nodesPerElement[i];
+				}
+			}
+
+			return gcnew ElementBlocks(elementTypes, elementCounts, nodesPerElement, elementTags, nodeTags);
+		}
+
+	private:
+		property Native::MshReader* Reader
+		{
+			Native::MshReader* get()
+			{
+				if (m_reader == nullptr) throw gcnew System::ObjectDisposedException("MshFile");
+				return m_reader;
+			}
+		}
+
+		static int CheckLength(size_t length)
+		{
+			if (length > static_cast<size_t>(System::Int32::MaxValue))
+				throw gcnew System::OverflowException("Too many values for a managed array; use the NativeBuffer overload.");
+
+			return static_cast<int>(length);
+		}
+
+		Native::MshReader* m_reader;
+	};
+}
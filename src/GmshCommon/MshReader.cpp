@@ -0,0 +1,387 @@
+// Compiled as native code.
+#include "MshReader.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			// Nodes or elements handed to one task when copying out
+			const size_t ChunkSize = 1 << 16;
+
+			struct Chunk
+			{
+				size_t block, begin, end, offset;
+			};
+
+			template<typename T>
+			T Read(const char*& ptr, const char* end)
+			{
+				if (static_cast<size_t>(end - ptr) < sizeof(T))
+					throw std::runtime_error("Unexpected end of MSH file.");
+
+				T value;
+				std::memcpy(&value, ptr, sizeof(T));
+				ptr += sizeof(T);
+				return value;
+			}
+
+			// Advances past 'count' items of 'size' bytes, checking for truncation and overflow.
+			const char* Skip(const char* ptr, const char* end, size_t count, size_t size)
+			{
+				if (size > 0 && count > static_cast<size_t>(end - ptr) / size)
+					throw std::runtime_error("Unexpected end of MSH file.");
+
+				return ptr + count * size;
+			}
+
+			void SkipSpace(const char*& ptr, const char* end)
+			{
+				while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n'))
+					++ptr;
+			}
+
+			std::string ReadLine(const char*& ptr, const char* end)
+			{
+				const char* start = ptr;
+				while (ptr < end && *ptr != '\n')
+					++ptr;
+
+				std::string line(start, ptr);
+				if (ptr < end) ++ptr;
+				if (!line.empty() && line.back() == '\r') line.pop_back();
+				return line;
+			}
+
+			void Expect(const char*& ptr, const char* end, const std::string& marker)
+			{
+				SkipSpace(ptr, end);
+				if (ReadLine(ptr, end) != marker)
+					throw std::runtime_error("Malformed MSH file: expected " + marker + ".");
+			}
+
+			// Splits the blocks selected by 'include' into chunks of at most ChunkSize
+			// items. Offsets number the items of the selected blocks consecutively.
+			template<typename Block, typename Predicate>
+			std::vector<Chunk> MakeChunks(const std::vector<Block>& blocks, Predicate include)
+			{
+				std::vector<Chunk> chunks;
+				size_t offset = 0;
+
+				for (size_t b = 0; b < blocks.size(); ++b)
+				{
+					if (!include(blocks[b])) continue;
+
+					for (size_t begin = 0; begin < blocks[b].count; begin += ChunkSize)
+					{
+						size_t end = std::min(blocks[b].count, begin + ChunkSize);
+						chunks.push_back({ b, begin, end, offset });
+						offset += end - begin;
+					}
+				}
+
+				return chunks;
+			}
+		}
+
+		size_t MshNodesPerElement(int elementType)
+		{
+			static const size_t table[] = {
+				0,
+				2, 3, 4, 4, 8, 6, 5, 3, 6, 9,
+				10, 27, 18, 14, 1, 8, 20, 15, 13, 9,
+				10, 12, 15, 15, 21, 4, 5, 6, 20, 35,
+				56, 22, 28
+			};
+
+			if (elementType < 1 || elementType >= static_cast<int>(sizeof(table) / sizeof(table[0])))
+				return 0;
+
+			return table[elementType];
+		}
+
+		MshReader::MshReader(const std::string& path)
+			: m_begin(nullptr), m_end(nullptr), m_numNodes(0), m_numElements(0), m_file(nullptr), m_mapping(nullptr)
+		{
+			size_t size = 0;
+
+#ifdef _WIN32
+			int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+			std::wstring widePath(length > 0 ? length : 1, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+			HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::runtime_error("Could not open " + path + ".");
+
+			LARGE_INTEGER fileSize;
+			HANDLE mapping = nullptr;
+			const void* view = nullptr;
+
+			if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+			{
+				mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping != nullptr)
+					view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+
+			if (view == nullptr)
+			{
+				if (mapping != nullptr) CloseHandle(mapping);
+				CloseHandle(file);
+				throw std::runtime_error("Could not map " + path + ".");
+			}
+
+			size = static_cast<size_t>(fileSize.QuadPart);
+			m_file = file;
+			m_mapping = mapping;
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				throw std::runtime_error("Could not open " + path + ".");
+
+			struct stat info;
+			void* view = MAP_FAILED;
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+				view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+			close(fd);
+			if (view == MAP_FAILED)
+				throw std::runtime_error("Could not map " + path + ".");
+
+			size = static_cast<size_t>(info.st_size);
+			m_mapping = view;
+#endif
+
+			m_begin = static_cast<const char*>(view);
+			m_end = m_begin + size;
+
+			try
+			{
+				Parse();
+			}
+			catch (...)
+			{
+				Close();
+				throw;
+			}
+		}
+
+		MshReader::~MshReader()
+		{
+			Close();
+		}
+
+		void MshReader::Close()
+		{
+			if (m_begin == nullptr) return;
+
+#ifdef _WIN32
+			UnmapViewOfFile(m_begin);
+			CloseHandle(static_cast<HANDLE>(m_mapping));
+			CloseHandle(static_cast<HANDLE>(m_file));
+#else
+			munmap(const_cast<char*>(m_begin), static_cast<size_t>(m_end - m_begin));
+#endif
+			m_begin = m_end = nullptr;
+		}
+
+		void MshReader::Parse()
+		{
+			const char* ptr = m_begin;
+
+			Expect(ptr, m_end, "$MeshFormat");
+
+			std::string format = ReadLine(ptr, m_end);
+			if (format.compare(0, 4, "4.1 ") != 0)
+				throw std::runtime_error("Only MSH 4.1 files are supported.");
+			if (format.compare(4, std::string::npos, "1 8") != 0)
+				throw std::runtime_error("Only binary MSH files with 8-byte size_t are supported.");
+
+			if (Read<int>(ptr, m_end) != 1)
+				throw std::runtime_error("MSH file was written with a different byte order.");
+
+			Expect(ptr, m_end, "$EndMeshFormat");
+
+			while (true)
+			{
+				SkipSpace(ptr, m_end);
+				if (ptr >= m_end) break;
+
+				std::string section = ReadLine(ptr, m_end);
+				if (section.empty() || section[0] != '$')
+					throw std::runtime_error("Malformed MSH file: expected a section.");
+
+				std::string name = section.substr(1);
+				if (name == "Nodes")
+					ParseNodes(ptr);
+				else if (name == "Elements")
+					ParseElements(ptr);
+				else
+				{
+					// Sections we do not read are skipped up to their end marker
+					std::string marker = "$End" + name;
+					const char* found = std::search(ptr, m_end, marker.begin(), marker.end());
+					if (found == m_end)
+						throw std::runtime_error("Malformed MSH file: missing " + marker + ".");
+
+					ptr = found;
+				}
+
+				Expect(ptr, m_end, "$End" + name);
+			}
+		}
+
+		void MshReader::ParseNodes(const char*& ptr)
+		{
+			size_t numBlocks = Read<size_t>(ptr, m_end);
+			m_numNodes = Read<size_t>(ptr, m_end);
+			Read<size_t>(ptr, m_end);
+			Read<size_t>(ptr, m_end);
+
+			size_t total = 0;
+			m_nodeBlocks.clear();
+
+			for (size_t i = 0; i < numBlocks; ++i)
+			{
+				MshNodeBlock block;
+				block.dim = Read<int>(ptr, m_end);
+				block.tag = Read<int>(ptr, m_end);
+				block.parametric = Read<int>(ptr, m_end) != 0;
+				block.count = Read<size_t>(ptr, m_end);
+				block.stride = 3 + (block.parametric ? block.dim : 0);
+
+				block.tags = ptr;
+				ptr = Skip(ptr, m_end, block.count, sizeof(size_t));
+				block.coords = ptr;
+				ptr = Skip(ptr, m_end, block.count, block.stride * sizeof(double));
+
+				total += block.count;
+				m_nodeBlocks.push_back(block);
+			}
+
+			if (total != m_numNodes)
+				throw std::runtime_error("Malformed MSH file: node count does not match its blocks.");
+		}
+
+		void MshReader::ParseElements(const char*& ptr)
+		{
+			size_t numBlocks = Read<size_t>(ptr, m_end);
+			m_numElements = Read<size_t>(ptr, m_end);
+			Read<size_t>(ptr, m_end);
+			Read<size_t>(ptr, m_end);
+
+			size_t total = 0;
+			m_elementBlocks.clear();
+
+			for (size_t i = 0; i < numBlocks; ++i)
+			{
+				MshElementBlock block;
+				block.dim = Read<int>(ptr, m_end);
+				block.tag = Read<int>(ptr, m_end);
+				block.elementType = Read<int>(ptr, m_end);
+				block.count = Read<size_t>(ptr, m_end);
+
+				block.nodesPerElement = MshNodesPerElement(block.elementType);
+				if (block.nodesPerElement == 0)
+					throw std::runtime_error("Unsupported element type " + std::to_string(block.elementType) + " in MSH file.");
+
+				block.stride = block.nodesPerElement + 1;
+				block.data = ptr;
+				ptr = Skip(ptr, m_end, block.count, block.stride * sizeof(size_t));
+
+				total += block.count;
+				m_elementBlocks.push_back(block);
+			}
+
+			if (total != m_numElements)
+				throw std::runtime_error("Malformed MSH file: element count does not match its blocks.");
+		}
+
+		std::vector<int> MshReader::ElementTypes() const
+		{
+			std::vector<int> types;
+			for (const MshElementBlock& block : m_elementBlocks)
+				if (std::find(types.begin(), types.end(), block.elementType) == types.end())
+					types.push_back(block.elementType);
+
+			return types;
+		}
+
+		size_t MshReader::CountElements(int elementType) const
+		{
+			size_t count = 0;
+			for (const MshElementBlock& block : m_elementBlocks)
+				if (elementType < 0 || block.elementType == elementType)
+					count += block.count;
+
+			return count;
+		}
+
+		void MshReader::CopyNodes(size_t* tags, double* coords) const
+		{
+			std::vector<Chunk> chunks = MakeChunks(m_nodeBlocks, [](const MshNodeBlock&) { return true; });
+
+			ParallelFor(chunks.size(), [&](size_t c)
+				{
+					const Chunk& chunk = chunks[c];
+					const MshNodeBlock& block = m_nodeBlocks[chunk.block];
+					size_t count = chunk.end - chunk.begin;
+
+					std::memcpy(tags + chunk.offset, block.tags + chunk.begin * sizeof(size_t), count * sizeof(size_t));
+
+					const char* src = block.coords + chunk.begin * block.stride * sizeof(double);
+					double* dst = coords + 3 * chunk.offset;
+
+					if (block.stride == 3)
+						std::memcpy(dst, src, 3 * count * sizeof(double));
+					else
+						for (size_t i = 0; i < count; ++i)
+							std::memcpy(dst + 3 * i, src + i * block.stride * sizeof(double), 3 * sizeof(double));
+				});
+		}
+
+		void MshReader::CopyElements(int elementType, size_t* elementTags, size_t* nodeTags) const
+		{
+			std::vector<Chunk> chunks = MakeChunks(m_elementBlocks,
+				[elementType](const MshElementBlock& block) { return block.elementType == elementType; });
+
+			ParallelFor(chunks.size(), [&](size_t c)
+				{
+					const Chunk& chunk = chunks[c];
+					const MshElementBlock& block = m_elementBlocks[chunk.block];
+					size_t npe = block.nodesPerElement;
+
+					const char* src = block.data + chunk.begin * block.stride * sizeof(size_t);
+					size_t* dstTags = elementTags + chunk.offset;
+					size_t* dstNodes = nodeTags + chunk.offset * npe;
+
+					for (size_t i = chunk.begin; i < chunk.end; ++i)
+					{
+						std::memcpy(dstTags++, src, sizeof(size_t));
+						std::memcpy(dstNodes, src + sizeof(size_t), npe * sizeof(size_t));
+
+						dstNodes += npe;
+						src += block.stride * sizeof(size_t);
+					}
+				});
+		}
+	}
+}
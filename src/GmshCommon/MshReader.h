@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// One entity block of the $Nodes section. 'tags' and 'coords' point into the
+		// mapped file and may be unaligned. Parametric blocks store dim extra values
+		// after each xyz, so consecutive nodes are 'stride' doubles apart.
+		struct MshNodeBlock
+		{
+			int dim, tag;
+			bool parametric;
+			size_t count, stride;
+			const char* tags;
+			const char* coords;
+		};
+
+		// One entity block of the $Elements section. Each element is stored as its tag
+		// followed by its node tags, 'stride' size_t values in all.
+		struct MshElementBlock
+		{
+			int dim, tag, elementType;
+			size_t count, nodesPerElement, stride;
+			const char* data;
+		};
+
+		// Read-only view of a binary MSH 4.1 file. The file is memory-mapped and only
+		// the block headers are parsed up front; nodes and elements are read from the
+		// mapping on demand, without going through gmsh. Throws std::runtime_error
+		// for files it cannot read.
+		class MshReader
+		{
+		public:
+			// 'path' is UTF-8.
+			explicit MshReader(const std::string& path);
+			~MshReader();
+
+			MshReader(const MshReader&) = delete;
+			MshReader& operator=(const MshReader&) = delete;
+
+			const std::vector<MshNodeBlock>& NodeBlocks() const { return m_nodeBlocks; }
+			const std::vector<MshElementBlock>& ElementBlocks() const { return m_elementBlocks; }
+
+			size_t NumNodes() const { return m_numNodes; }
+			size_t NumElements() const { return m_numElements; }
+
+			// Distinct element types, in order of first appearance.
+			std::vector<int> ElementTypes() const;
+
+			// Number of elements of 'elementType' (all types if < 0) in all blocks.
+			size_t CountElements(int elementType) const;
+
+			// All node tags, and their xyz coordinates as triplets, in file order.
+			void CopyNodes(size_t* tags, double* coords) const;
+
+			// The tags and node tags of all elements of 'elementType', in file order.
+			void CopyElements(int elementType, size_t* elementTags, size_t* nodeTags) const;
+
+		private:
+			void Close();
+			void Parse();
+			void ParseNodes(const char*& ptr);
+			void ParseElements(const char*& ptr);
+
+			const char* m_begin;
+			const char* m_end;
+			size_t m_numNodes, m_numElements;
+			std::vector<MshNodeBlock> m_nodeBlocks;
+			std::vector<MshElementBlock> m_elementBlocks;
+
+			void* m_file;
+			void* m_mapping;
+		};
+
+		// Nodes per element for the fixed-size MSH element types, 0 for unknown types.
+		size_t MshNodesPerElement(int elementType);
+	}
+}
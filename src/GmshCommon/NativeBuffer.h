@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		struct Storage
+		{
+			virtual ~Storage() {}
+			virtual void* Data() = 0;
+			virtual size_t Count() const = 0;
+		};
+
+		template<typename T>
+		struct VectorStorage : Storage
+		{
+			std::vector<T> values;
+
+			VectorStorage(std::vector<T>& source)
+			{
+				values.swap(source);
+			}
+
+			void* Data() override { return values.data(); }
+			size_t Count() const override { return values.size(); }
+		};
+	}
+
+	/// <summary>
+	/// A block of native memory filled by Gmsh and handed to .NET without copying.
+	/// The memory stays valid until the buffer is disposed (or finalized).
+	/// </summary>
+	public ref class NativeBuffer : System::IDisposable
+	{
+	public:
+		~NativeBuffer()
+		{
+			this->!NativeBuffer();
+		}
+
+		!NativeBuffer()
+		{
+			if (m_storage != nullptr)
+			{
+				long long bytes = Bytes;
+				delete m_storage;
+				m_storage = nullptr;
+
+				if (bytes > 0)
+					System::GC::RemoveMemoryPressure(bytes);
+			}
+		}
+
+		property IntPtr Pointer
+		{
+			IntPtr get()
+			{
+				if (m_storage == nullptr) throw gcnew System::ObjectDisposedException("NativeBuffer");
+				return IntPtr(m_storage->Data());
+			}
+		}
+
+		property long long Length
+		{
+			long long get() { return m_storage == nullptr ? 0 : static_cast<long long>(m_storage->Count()); }
+		}
+
+		property int ElementSize
+		{
+			int get() { return m_elementSize; }
+		}
+
+		property long long Bytes
+		{
+			long long get() { return Length * m_elementSize; }
+		}
+
+		property System::Boolean IsDisposed
+		{
+			System::Boolean get() { return m_storage == nullptr; }
+		}
+
+		void CopyTo(array<double>^ destination, long long sourceIndex, int destinationIndex, int length)
+		{
+			CheckCopy(sizeof(double), sourceIndex, length);
+			Marshal::Copy(IntPtr(static_cast<double*>(m_storage->Data()) + sourceIndex), destination, destinationIndex, length);
+		}
+
+		void CopyTo(array<IntPtr>^ destination, long long sourceIndex, int destinationIndex, int length)
+		{
+			CheckCopy(sizeof(size_t), sourceIndex, length);
+			Marshal::Copy(IntPtr(static_cast<size_t*>(m_storage->Data()) + sourceIndex), destination, destinationIndex, length);
+		}
+
+		void CopyTo(array<int>^ destination, long long sourceIndex, int destinationIndex, int length)
+		{
+			CheckCopy(sizeof(int), sourceIndex, length);
+			Marshal::Copy(IntPtr(static_cast<int*>(m_storage->Data()) + sourceIndex), destination, destinationIndex, length);
+		}
+
+	internal:
+		NativeBuffer(Native::Storage* storage, int elementSize) : m_storage(storage), m_elementSize(elementSize)
+		{
+			long long bytes = Bytes;
+			if (bytes > 0)
+				System::GC::AddMemoryPressure(bytes);
+		}
+
+	private:
+		void CheckCopy(int elementSize, long long sourceIndex, int length)
+		{
+			if (m_storage == nullptr) throw gcnew System::ObjectDisposedException("NativeBuffer");
+			if (elementSize != m_elementSize) throw gcnew System::ArgumentException("Destination type does not match buffer element type.");
+			if (sourceIndex < 0 || length < 0 || sourceIndex + length > Length) throw gcnew System::ArgumentOutOfRangeException("length");
+		}
+
+		Native::Storage* m_storage;
+		int m_elementSize;
+	};
+
+	namespace Native {
+
+		// Takes ownership of the contents of 'values', leaving it empty.
+		template<typename T>
+		NativeBuffer^ Adopt(std::vector<T>& values)
+		{
+			return gcnew NativeBuffer(new VectorStorage<T>(values), sizeof(T));
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <msclr\marshal_cppstd.h>
+
+#include "OptionSet.h"
+#include "MeshCache.h"
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// A reusable set of gmsh options. Names and values are marshalled once, when
+	/// they are added; Apply then sets the whole profile in one native call and
+	/// skips options that already have the profile's value.
+	/// </summary>
+	public ref class OptionProfile : System::IDisposable
+	{
+	public:
+		OptionProfile()
+		{
+			m_set = new Native::OptionSet();
+		}
+
+		~OptionProfile()
+		{
+			this->!OptionProfile();
+		}
+
+		!OptionProfile()
+		{
+			delete m_set;
+			m_set = nullptr;
+		}
+
+		property int Count
+		{
+			int get() { return static_cast<int>(Set->Values().size()); }
+		}
+
+		// Adds the option, or replaces its value if it is already in the profile.
+		void SetNumber(System::String^ name, double value)
+		{
+			Set->SetNumber(msclr::interop::marshal_as<std::string>(name), value);
+			MeshCache::TrackOption(name, false);
+		}
+
+		void SetString(System::String^ name, System::String^ value)
+		{
+			Set->SetString(msclr::interop::marshal_as<std::string>(name), msclr::interop::marshal_as<std::string>(value));
+			MeshCache::TrackOption(name, true);
+		}
+
+		bool Remove(System::String^ name)
+		{
+			return Set->Remove(msclr::interop::marshal_as<std::string>(name));
+		}
+
+		// Sets every option whose current value differs. Returns how many were set.
+		int Apply()
+		{
+			return static_cast<int>(Set->Apply());
+		}
+
+		// A profile with the current values of this profile's options.
+		OptionProfile^ Snapshot()
+		{
+			OptionProfile^ snapshot = gcnew OptionProfile();
+			Set->Capture(*snapshot->m_set);
+			return snapshot;
+		}
+
+		// Applies the profile and returns a scope that restores the previous values
+		// when it is disposed.
+		System::IDisposable^ ApplyScoped()
+		{
+			OptionProfile^ previous = Snapshot();
+			Apply();
+			return gcnew Scope(previous);
+		}
+
+		// Names of the options whose current value differs from the profile.
+		array<System::String^>^ Diff()
+		{
+			std::vector<size_t> changed;
+			Set->Diff(changed);
+
+			const std::vector<Native::OptionValue>& values = Set->Values();
+			array<System::String^>^ names = gcnew array<System::String^>(static_cast<int>(changed.size()));
+			for (int i = 0; i < names->Length; ++i)
+				names[i] = gcnew System::String(values[changed[i]].name.c_str());
+
+			return names;
+		}
+
+	private:
+		ref class Scope : System::IDisposable
+		{
+		public:
+			Scope(OptionProfile^ previous) : m_previous(previous) {}
+
+			~Scope()
+			{
+				if (m_previous == nullptr) return;
+
+				m_previous->Apply();
+				delete m_previous;
+				m_previous = nullptr;
+			}
+
+		private:
+			OptionProfile^ m_previous;
+		};
+
+		property Native::OptionSet* Set
+		{
+			Native::OptionSet* get()
+			{
+				if (m_set == nullptr) throw gcnew System::ObjectDisposedException("OptionProfile");
+				return m_set;
+			}
+		}
+
+		Native::OptionSet* m_set;
+	};
+}
@@ -0,0 +1,104 @@
+// Compiled as native code.
+#include "OptionSet.h"
+
+#include "gmsh.h"
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		void OptionSet::SetNumber(const std::string& name, double value)
+		{
+			Find(name, false).number = value;
+		}
+
+		void OptionSet::SetString(const std::string& name, const std::string& value)
+		{
+			Find(name, true).text = value;
+		}
+
+		bool OptionSet::Remove(const std::string& name)
+		{
+			for (size_t i = 0; i < m_values.size(); ++i)
+			{
+				if (m_values[i].name == name)
+				{
+					m_values.erase(m_values.begin() + i);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		size_t OptionSet::Apply() const
+		{
+			size_t count = 0;
+			for (const OptionValue& option : m_values)
+			{
+				if (IsCurrent(option)) continue;
+
+				if (option.isString)
+					gmsh::option::setString(option.name, option.text);
+				else
+					gmsh::option::setNumber(option.name, option.number);
+				++count;
+			}
+
+			return count;
+		}
+
+		void OptionSet::Capture(OptionSet& snapshot) const
+		{
+			snapshot.m_values = m_values;
+			for (OptionValue& option : snapshot.m_values)
+			{
+				if (option.isString)
+					gmsh::option::getString(option.name, option.text);
+				else
+					gmsh::option::getNumber(option.name, option.number);
+			}
+		}
+
+		void OptionSet::Diff(std::vector<size_t>& changed) const
+		{
+			changed.clear();
+			for (size_t i = 0; i < m_values.size(); ++i)
+				if (!IsCurrent(m_values[i]))
+					changed.push_back(i);
+		}
+
+		OptionValue& OptionSet::Find(const std::string& name, bool isString)
+		{
+			for (OptionValue& option : m_values)
+			{
+				if (option.name == name)
+				{
+					option.isString = isString;
+					return option;
+				}
+			}
+
+			OptionValue option;
+			option.name = name;
+			option.isString = isString;
+			option.number = 0;
+			m_values.push_back(option);
+			return m_values.back();
+		}
+
+		bool OptionSet::IsCurrent(const OptionValue& option) const
+		{
+			if (option.isString)
+			{
+				std::string current;
+				gmsh::option::getString(option.name, current);
+				return current == option.text;
+			}
+
+			double current;
+			gmsh::option::getNumber(option.name, current);
+			return current == option.number;
+		}
+	}
+}
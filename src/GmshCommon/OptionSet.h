@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		struct OptionValue
+		{
+			std::string name;
+			bool isString;
+			double number;
+			std::string text;
+		};
+
+		// A list of gmsh options with their values, kept in native form so that
+		// applying, capturing and comparing them needs no marshalling.
+		class OptionSet
+		{
+		public:
+			// Adds the option, or replaces its value if it is already in the set.
+			void SetNumber(const std::string& name, double value);
+			void SetString(const std::string& name, const std::string& value);
+
+			bool Remove(const std::string& name);
+
+			const std::vector<OptionValue>& Values() const { return m_values; }
+
+			// Sets the options whose current value differs from the one in the set.
+			// Returns how many were set.
+			size_t Apply() const;
+
+			// The current values of the options in this set.
+			void Capture(OptionSet& snapshot) const;
+
+			// Indices of the options whose current value differs from the one in the set.
+			void Diff(std::vector<size_t>& changed) const;
+
+		private:
+			OptionValue& Find(const std::string& name, bool isString);
+			bool IsCurrent(const OptionValue& option) const;
+
+			std::vector<OptionValue> m_values;
+		};
+	}
+}
@@ -0,0 +1,145 @@
+// Compiled as native code: <thread> and <mutex> are not available under /clr.
+#include "Parallel.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			thread_local bool insidePool = false;
+
+			// Fixed set of worker threads shared by every ParallelFor call. The caller
+			// takes part in its own job, so a pool of n workers runs n + 1 tasks at once.
+			class ThreadPool
+			{
+			public:
+				explicit ThreadPool(size_t numWorkers)
+				{
+					for (size_t i = 0; i < numWorkers; ++i)
+						m_workers.emplace_back([this] { Work(); });
+				}
+
+				void Run(size_t numTasks, const std::function<void(size_t)>& task)
+				{
+					std::lock_guard<std::mutex> runLock(m_runMutex);
+
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_task = &task;
+						m_numTasks = numTasks;
+						m_nextTask = 0;
+						m_pending = numTasks;
+						m_error = nullptr;
+						++m_generation;
+					}
+					m_wake.notify_all();
+
+					insidePool = true;
+					RunTasks();
+					insidePool = false;
+
+					std::exception_ptr error;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_done.wait(lock, [this] { return m_pending == 0; });
+						m_task = nullptr;
+						error = m_error;
+					}
+
+					if (error) std::rethrow_exception(error);
+				}
+
+			private:
+				void RunTasks()
+				{
+					for (;;)
+					{
+						const std::function<void(size_t)>* task;
+						size_t index;
+						{
+							std::lock_guard<std::mutex> lock(m_mutex);
+							if (m_task == nullptr || m_nextTask >= m_numTasks) return;
+							task = m_task;
+							index = m_nextTask++;
+						}
+
+						std::exception_ptr error;
+						try
+						{
+							(*task)(index);
+						}
+						catch (...)
+						{
+							error = std::current_exception();
+						}
+
+						std::lock_guard<std::mutex> lock(m_mutex);
+						if (error && !m_error) m_error = error;
+						if (--m_pending == 0) m_done.notify_all();
+					}
+				}
+
+				void Work()
+				{
+					insidePool = true;
+
+					size_t seen = 0;
+					for (;;)
+					{
+						{
+							std::unique_lock<std::mutex> lock(m_mutex);
+							m_wake.wait(lock, [&] { return m_generation != seen; });
+							seen = m_generation;
+						}
+
+						RunTasks();
+					}
+				}
+
+				std::vector<std::thread> m_workers;
+				std::mutex m_runMutex, m_mutex;
+				std::condition_variable m_wake, m_done;
+
+				const std::function<void(size_t)>* m_task = nullptr;
+				size_t m_numTasks = 0, m_nextTask = 0, m_pending = 0, m_generation = 0;
+				std::exception_ptr m_error;
+			};
+
+			ThreadPool& Pool()
+			{
+				// Never destroyed: joining threads while the DLL unloads would deadlock
+				// on the loader lock, so the workers simply end with the process.
+				static ThreadPool* pool = new ThreadPool(DefaultNumTasks() - 1);
+				return *pool;
+			}
+		}
+
+		size_t DefaultNumTasks()
+		{
+			size_t n = std::thread::hardware_concurrency();
+			return n > 0 ? n : 1;
+		}
+
+		void ParallelFor(size_t numTasks, const std::function<void(size_t)>& task)
+		{
+			if (numTasks < 1) return;
+
+			// Nested calls run serially rather than waiting on the pool they occupy.
+			if (numTasks == 1 || insidePool)
+			{
+				for (size_t i = 0; i < numTasks; ++i)
+					task(i);
+				return;
+			}
+
+			Pool().Run(numTasks, task);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Number of tasks to use when the caller does not specify one.
+		size_t DefaultNumTasks();
+
+		// Runs task(i) for every i in [0, numTasks) on a shared pool of native threads
+		// and returns once all of them have finished. The calling thread takes part.
+		// The first exception thrown by a task is rethrown here.
+		void ParallelFor(size_t numTasks, const std::function<void(size_t)>& task);
+	}
+}
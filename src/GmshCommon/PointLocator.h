@@ -0,0 +1,229 @@
+#pragma once
+
+#include "gmsh.h"
+#include <stdexcept>
+
+#include "ElementBvh.h"
+#include "FieldTransfer.h"
+#include "MeshBlock.h"
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Finds the elements of a linear mesh (3-node triangles, 4-node tetrahedra or
+	/// 8-node hexahedra) that contain given points, using a bounding volume hierarchy
+	/// built once over the element boxes. Local coordinates follow Gmsh conventions.
+	/// </summary>
+	public ref class PointLocator : System::IDisposable
+	{
+	public:
+		// 'coords' holds xyz triplets; 'connectivity' holds nodesPerElement zero-based
+		// indices per element. 'tolerance' is relative to the element size.
+		PointLocator(array<double>^ coords, array<int>^ connectivity, int nodesPerElement, double tolerance)
+		{
+			if (coords == nullptr || connectivity == nullptr) throw gcnew System::ArgumentNullException();
+			if (nodesPerElement < 1 || connectivity->Length % nodesPerElement != 0)
+				throw gcnew System::ArgumentException("Connectivity length is not a multiple of the nodes per element.");
+
+			pin_ptr<double> pCoords = coords->Length > 0 ? &coords[0] : nullptr;
+			pin_ptr<int> pConnectivity = connectivity->Length > 0 ? &connectivity[0] : nullptr;
+
+			m_bvh = Create(pCoords, coords->Length / 3, pConnectivity, connectivity->Length / nodesPerElement, nodesPerElement, tolerance);
+		}
+
+		// Locator over the elements of type 'elementType' (2, 4 or 5) on entity 'tag' of
+		// the current model. Element indices refer to ElementTags, nodal values passed
+		// to Interpolate follow NodeTags.
+		static PointLocator^ FromMesh(int elementType, int tag, double tolerance)
+		{
+			int nodesPerElement;
+			switch (elementType)
+			{
+			case 2: nodesPerElement = 3; break;
+			case 4: nodesPerElement = 4; break;
+			case 5: nodesPerElement = 8; break;
+			default: throw gcnew System::ArgumentException("Only 3-node triangles (2), 4-node tetrahedra (4) and 8-node hexahedra (5) are supported.");
+			}
+
+			Native::MeshBlock block;
+			Native::GetMeshBlock(elementType, tag, block);
+
+			PointLocator^ locator = gcnew PointLocator(Create(block.coords.data(), block.nodeTags.size(), block.connectivity.data(), block.elementTags.size(), nodesPerElement, tolerance));
+
+			locator->m_elementTags = gcnew array<IntPtr>(static_cast<int>(block.elementTags.size()));
+			if (block.elementTags.size() > 0)
+				Marshal::Copy(IntPtr(block.elementTags.data()), locator->m_elementTags, 0, locator->m_elementTags->Length);
+
+			locator->m_nodeTags = gcnew array<IntPtr>(static_cast<int>(block.nodeTags.size()));
+			if (block.nodeTags.size() > 0)
+				Marshal::Copy(IntPtr(block.nodeTags.data()), locator->m_nodeTags, 0, locator->m_nodeTags->Length);
+
+			return locator;
+		}
+
+		~PointLocator()
+		{
+			this->!PointLocator();
+		}
+
+		!PointLocator()
+		{
+			delete m_bvh;
+			m_bvh = nullptr;
+		}
+
+		property int NumElements
+		{
+			int get() { return static_cast<int>(Bvh->NumElements()); }
+		}
+
+		property int NodesPerElement
+		{
+			int get() { return Bvh->NodesPerElement(); }
+		}
+
+		// Gmsh tags of the elements when created with FromMesh, otherwise null.
+		property array<IntPtr>^ ElementTags
+		{
+			array<IntPtr>^ get() { return m_elementTags; }
+		}
+
+		// Gmsh tags of the source nodes when created with FromMesh, otherwise null.
+		property array<IntPtr>^ NodeTags
+		{
+			array<IntPtr>^ get() { return m_nodeTags; }
+		}
+
+		// Locates every point of 'points' (xyz triplets) in parallel. 'elements' receives
+		// the element index per point (-1 if outside the mesh), 'localCoords' three
+		// local coordinates per point. Returns the number of points found.
+		int Locate(array<double>^ points,
+			[System::Runtime::InteropServices::Out] array<int>^% elements,
+			[System::Runtime::InteropServices::Out] array<double>^% localCoords)
+		{
+			if (points == nullptr) throw gcnew System::ArgumentNullException("points");
+
+			int numPoints = points->Length / 3;
+			elements = gcnew array<int>(numPoints);
+			localCoords = gcnew array<double>(numPoints * 3);
+			if (numPoints < 1) return 0;
+
+			pin_ptr<double> pPoints = &points[0], pLocal = &localCoords[0];
+			pin_ptr<int> pElements = &elements[0];
+
+			return static_cast<int>(Bvh->Locate(pPoints, numPoints, pElements, pLocal));
+		}
+
+		int Locate(double x, double y, double z,
+			[System::Runtime::InteropServices::Out] double% u,
+			[System::Runtime::InteropServices::Out] double% v,
+			[System::Runtime::InteropServices::Out] double% w)
+		{
+			double point[3] = { x, y, z }, local[3];
+			int element = Bvh->Locate(point, local);
+
+			u = local[0];
+			v = local[1];
+			w = local[2];
+
+			return element;
+		}
+
+		// Interpolates 'nodalValues' (numComponents per node of the source mesh) at
+		// 'points' (xyz triplets), in parallel. Points outside the mesh get 'outsideValue'.
+		array<double>^ Interpolate(array<double>^ nodalValues, int numComponents, array<double>^ points, double outsideValue)
+		{
+			CheckValues(nodalValues, numComponents);
+			if (points == nullptr) throw gcnew System::ArgumentNullException("points");
+
+			int numPoints = points->Length / 3;
+			array<double>^ output = gcnew array<double>(numPoints * numComponents);
+			if (numPoints < 1) return output;
+			if (nodalValues->Length < 1) throw gcnew System::ArgumentException("The source mesh has no nodes.", "nodalValues");
+
+			pin_ptr<double> pValues = &nodalValues[0], pPoints = &points[0], pOutput = &output[0];
+			Native::TransferField(*Bvh, pValues, numComponents, pPoints, numPoints, outsideValue, pOutput);
+
+			return output;
+		}
+
+		// As above, for points already located with Locate. Locating once and
+		// interpolating several fields avoids repeating the search.
+		array<double>^ Interpolate(array<double>^ nodalValues, int numComponents, array<int>^ elements, array<double>^ localCoords, double outsideValue)
+		{
+			CheckValues(nodalValues, numComponents);
+			if (elements == nullptr || localCoords == nullptr) throw gcnew System::ArgumentNullException();
+			if (localCoords->Length != elements->Length * 3)
+				throw gcnew System::ArgumentException("Expected three local coordinates per element index.");
+
+			int numPoints = elements->Length;
+			for (int i = 0; i < numPoints; ++i)
+				if (elements[i] >= NumElements)
+					throw gcnew System::IndexOutOfRangeException("Element index out of range.");
+
+			array<double>^ output = gcnew array<double>(numPoints * numComponents);
+			if (numPoints < 1) return output;
+			if (nodalValues->Length < 1) throw gcnew System::ArgumentException("The source mesh has no nodes.", "nodalValues");
+
+			pin_ptr<double> pValues = &nodalValues[0], pLocal = &localCoords[0], pOutput = &output[0];
+			pin_ptr<int> pElements = &elements[0];
+			Native::EvaluateField(*Bvh, pValues, numComponents, pElements, pLocal, numPoints, outsideValue, pOutput);
+
+			return output;
+		}
+
+		// Nodal interpolation weights of a linear element (3, 4 or 8 nodes) at local coordinates (u, v, w).
+		static array<double>^ GetWeights(int nodesPerElement, double u, double v, double w)
+		{
+			if (nodesPerElement != 3 && nodesPerElement != 4 && nodesPerElement != 8)
+				throw gcnew System::ArgumentException("Only 3-, 4- and 8-node elements are supported.");
+
+			double local[3] = { u, v, w }, weights[8];
+			Native::ShapeFunctions(nodesPerElement, local, weights);
+
+			array<double>^ output = gcnew array<double>(nodesPerElement);
+			Marshal::Copy(IntPtr(weights), output, 0, nodesPerElement);
+			return output;
+		}
+
+	internal:
+		property Native::ElementBvh* Bvh
+		{
+			Native::ElementBvh* get()
+			{
+				if (m_bvh == nullptr) throw gcnew System::ObjectDisposedException("PointLocator");
+				return m_bvh;
+			}
+		}
+
+	private:
+		PointLocator(Native::ElementBvh* bvh) : m_bvh(bvh) {}
+
+		void CheckValues(array<double>^ nodalValues, int numComponents)
+		{
+			if (nodalValues == nullptr) throw gcnew System::ArgumentNullException("nodalValues");
+			if (numComponents < 1) throw gcnew System::ArgumentOutOfRangeException("numComponents");
+			if (static_cast<size_t>(nodalValues->Length) != Bvh->Coords().size() / 3 * numComponents)
+				throw gcnew System::ArgumentException("Expected numComponents values per source node.");
+		}
+
+		static Native::ElementBvh* Create(const double* coords, size_t numNodes, const int* connectivity, size_t numElements, int nodesPerElement, double tolerance)
+		{
+			try
+			{
+				return new Native::ElementBvh(coords, numNodes, connectivity, numElements, nodesPerElement, tolerance);
+			}
+			catch (const std::exception& e)
+			{
+				throw gcnew System::ArgumentException(gcnew System::String(e.what()));
+			}
+		}
+
+		Native::ElementBvh* m_bvh;
+		array<IntPtr>^ m_elementTags;
+		array<IntPtr>^ m_nodeTags;
+	};
+}
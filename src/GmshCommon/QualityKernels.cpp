@@ -0,0 +1,288 @@
+// Compiled as native code. Each kernel is written once against a small vector
+// abstraction and instantiated for plain doubles and for AVX2 (4 doubles).
+#include "QualityKernels.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			const double RadToDeg = 57.295779513082320876798;
+			const double TetraGammaScale = 8.479670;			// as in Gmsh.GH Tetra.GetTetraQuality
+			const double TriangleGammaScale = 2.309401076758503;	// 4 / sqrt(3)
+			const double TetraAspectScale = 4.898979485566356;		// 2 * sqrt(6)
+			const double TriangleAspectScale = 6.928203230275509;	// 4 * sqrt(3)
+
+			const size_t BlockSize = 16384;
+
+			// Scalar lane
+
+			inline double Sqrt(double a) { return std::sqrt(a); }
+			inline double Min(double a, double b) { return a < b ? a : b; }
+			inline double Max(double a, double b) { return a > b ? a : b; }
+			inline double Abs(double a) { return std::abs(a); }
+
+			template<typename V>
+			V Gather(const double* base, const int* connectivity, int stride, int k);
+
+			template<>
+			inline double Gather<double>(const double* base, const int* connectivity, int /*stride*/, int k)
+			{
+				return base[connectivity[k]];
+			}
+
+			inline void Store(double* output, double value) { *output = value; }
+
+#if GMSHCOMMON_AVX2
+			// AVX2 lane
+
+			struct D4
+			{
+				__m256d v;
+
+				D4() {}
+				D4(__m256d value) : v(value) {}
+				explicit D4(double value) : v(_mm256_set1_pd(value)) {}
+			};
+
+			inline D4 operator+(D4 a, D4 b) { return _mm256_add_pd(a.v, b.v); }
+			inline D4 operator-(D4 a, D4 b) { return _mm256_sub_pd(a.v, b.v); }
+			inline D4 operator*(D4 a, D4 b) { return _mm256_mul_pd(a.v, b.v); }
+			inline D4 operator/(D4 a, D4 b) { return _mm256_div_pd(a.v, b.v); }
+			inline D4 operator-(D4 a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+			inline D4 Sqrt(D4 a) { return _mm256_sqrt_pd(a.v); }
+			inline D4 Min(D4 a, D4 b) { return _mm256_min_pd(a.v, b.v); }
+			inline D4 Max(D4 a, D4 b) { return _mm256_max_pd(a.v, b.v); }
+			inline D4 Abs(D4 a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+
+			template<>
+			inline D4 Gather<D4>(const double* base, const int* connectivity, int stride, int k)
+			{
+				__m128i index = _mm_setr_epi32(connectivity[k], connectivity[stride + k], connectivity[2 * stride + k], connectivity[3 * stride + k]);
+				return _mm256_i32gather_pd(base, index, 8);
+			}
+
+			inline void Store(double* output, D4 value) { _mm256_storeu_pd(output, value.v); }
+#endif
+
+			template<typename V>
+			struct Vec3
+			{
+				V x, y, z;
+			};
+
+			template<typename V>
+			inline Vec3<V> Sub(const Vec3<V>& a, const Vec3<V>& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+
+			template<typename V>
+			inline V Dot(const Vec3<V>& a, const Vec3<V>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+			template<typename V>
+			inline Vec3<V> Cross(const Vec3<V>& a, const Vec3<V>& b)
+			{
+				return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+			}
+
+			template<typename V>
+			inline Vec3<V> Load(const double* x, const double* y, const double* z, const int* connectivity, int stride, int k)
+			{
+				return { Gather<V>(x, connectivity, stride, k), Gather<V>(y, connectivity, stride, k), Gather<V>(z, connectivity, stride, k) };
+			}
+
+			// Stores the largest cosine in minAngle; the caller converts it to degrees.
+			template<typename V>
+			inline void TetrahedronKernel(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t i)
+			{
+				Vec3<V> a = Load<V>(x, y, z, connectivity, 4, 0);
+				Vec3<V> b = Load<V>(x, y, z, connectivity, 4, 1);
+				Vec3<V> c = Load<V>(x, y, z, connectivity, 4, 2);
+				Vec3<V> d = Load<V>(x, y, z, connectivity, 4, 3);
+
+				Vec3<V> ab = Sub(b, a), ac = Sub(c, a), ad = Sub(d, a);
+				Vec3<V> bc = Sub(c, b), bd = Sub(d, b), cd = Sub(d, c);
+
+				V lab = Dot(ab, ab), lac = Dot(ac, ac), lad = Dot(ad, ad);
+				V lbc = Dot(bc, bc), lbd = Dot(bd, bd), lcd = Dot(cd, cd);
+
+				V minEdge = Sqrt(Min(Min(Min(lab, lac), Min(lad, lbc)), Min(lbd, lcd)));
+				V maxEdge = Sqrt(Max(Max(Max(lab, lac), Max(lad, lbc)), Max(lbd, lcd)));
+
+				V volume6 = Abs(Dot(ab, Cross(ac, ad)));
+				V volume = volume6 / V(6.0);
+
+				V srms = Sqrt((lab + lac + lad + lbc + lbd + lcd) / V(6.0));
+				V gamma = srms * srms * srms / (V(TetraGammaScale) * volume);
+
+				// Face normals, all outward (or all inward for a negatively oriented element)
+				Vec3<V> na = Cross(bc, bd), nb = Cross(ad, ac), nc = Cross(ab, ad), nd = Cross(ac, ab);
+				V la = Sqrt(Dot(na, na)), lb = Sqrt(Dot(nb, nb)), lc = Sqrt(Dot(nc, nc)), ld = Sqrt(Dot(nd, nd));
+
+				// Inradius = 3 V / total face area = |6 V| / sum |n|
+				V inradius = volume6 / (la + lb + lc + ld);
+				V aspect = maxEdge / (V(TetraAspectScale) * inradius);
+
+				// Dihedral angle between two faces: cos = -n_i . n_j / (|n_i| |n_j|)
+				V maxCos = -Dot(na, nb) / (la * lb);
+				maxCos = Max(maxCos, -Dot(na, nc) / (la * lc));
+				maxCos = Max(maxCos, -Dot(na, nd) / (la * ld));
+				maxCos = Max(maxCos, -Dot(nb, nc) / (lb * lc));
+				maxCos = Max(maxCos, -Dot(nb, nd) / (lb * ld));
+				maxCos = Max(maxCos, -Dot(nc, nd) / (lc * ld));
+
+				Store(out.size + i, volume);
+				Store(out.gamma + i, gamma);
+				Store(out.aspectRatio + i, aspect);
+				Store(out.minEdge + i, minEdge);
+				Store(out.maxEdge + i, maxEdge);
+				Store(out.minAngle + i, maxCos);
+			}
+
+			template<typename V>
+			inline void TriangleKernel(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t i)
+			{
+				Vec3<V> a = Load<V>(x, y, z, connectivity, 3, 0);
+				Vec3<V> b = Load<V>(x, y, z, connectivity, 3, 1);
+				Vec3<V> c = Load<V>(x, y, z, connectivity, 3, 2);
+
+				Vec3<V> ab = Sub(b, a), ac = Sub(c, a), bc = Sub(c, b);
+
+				V lab = Dot(ab, ab), lac = Dot(ac, ac), lbc = Dot(bc, bc);
+				V eab = Sqrt(lab), eac = Sqrt(lac), ebc = Sqrt(lbc);
+
+				V minEdge = Min(Min(eab, eac), ebc);
+				V maxEdge = Max(Max(eab, eac), ebc);
+
+				Vec3<V> n = Cross(ab, ac);
+				V area = Sqrt(Dot(n, n)) / V(2.0);
+
+				V gamma = (lab + lac + lbc) / (V(3.0) * V(TriangleGammaScale) * area);
+
+				// Inradius = area / semiperimeter
+				V aspect = maxEdge * (eab + eac + ebc) / (V(TriangleAspectScale) * area);
+
+				V maxCos = Dot(ab, ac) / (eab * eac);
+				maxCos = Max(maxCos, -Dot(ab, bc) / (eab * ebc));
+				maxCos = Max(maxCos, Dot(ac, bc) / (eac * ebc));
+
+				Store(out.size + i, area);
+				Store(out.gamma + i, gamma);
+				Store(out.aspectRatio + i, aspect);
+				Store(out.minEdge + i, minEdge);
+				Store(out.maxEdge + i, maxEdge);
+				Store(out.minAngle + i, maxCos);
+			}
+
+#if GMSHCOMMON_AVX2
+			void TetrahedronBlockAvx2(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t begin, size_t end)
+			{
+				size_t i = begin;
+				for (; i + 4 <= end; i += 4)
+					TetrahedronKernel<D4>(x, y, z, connectivity + i * 4, out, i);
+				for (; i < end; ++i)
+					TetrahedronKernel<double>(x, y, z, connectivity + i * 4, out, i);
+			}
+
+			void TriangleBlockAvx2(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t begin, size_t end)
+			{
+				size_t i = begin;
+				for (; i + 4 <= end; i += 4)
+					TriangleKernel<D4>(x, y, z, connectivity + i * 3, out, i);
+				for (; i < end; ++i)
+					TriangleKernel<double>(x, y, z, connectivity + i * 3, out, i);
+			}
+
+#endif
+
+			void TetrahedronBlock(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					TetrahedronKernel<double>(x, y, z, connectivity + i * 4, out, i);
+			}
+
+			void TriangleBlock(const double* x, const double* y, const double* z, const int* connectivity, const QualityOutput& out, size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					TriangleKernel<double>(x, y, z, connectivity + i * 3, out, i);
+			}
+
+			void CosineToDegrees(double* values, size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					values[i] = std::acos(std::min(1.0, std::max(-1.0, values[i]))) * RadToDeg;
+			}
+
+			typedef void (*BlockFunction)(const double*, const double*, const double*, const int*, const QualityOutput&, size_t, size_t);
+
+			void Run(BlockFunction block, const double* x, const double* y, const double* z, const int* connectivity, size_t numElements, const QualityOutput& output)
+			{
+				size_t numBlocks = (numElements + BlockSize - 1) / BlockSize;
+
+				ParallelFor(numBlocks, [&](size_t b)
+					{
+						size_t begin = b * BlockSize, end = std::min(numElements, begin + BlockSize);
+						block(x, y, z, connectivity, output, begin, end);
+						CosineToDegrees(output.minAngle, begin, end);
+					});
+			}
+		}
+
+		bool HasAvx2()
+		{
+#ifdef _MSC_VER
+			static const bool hasAvx2 = []
+				{
+					int info[4];
+					__cpuid(info, 0);
+					if (info[0] < 7) return false;
+
+					__cpuid(info, 1);
+					bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+					if (!osxsave || !avx) return false;
+					if ((_xgetbv(0) & 6) != 6) return false;
+
+					__cpuidex(info, 7, 0);
+					return (info[1] & (1 << 5)) != 0;
+				}();
+			return hasAvx2;
+#elif GMSHCOMMON_AVX2
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		}
+
+		void TetrahedronQuality(const double* x, const double* y, const double* z, const int* connectivity, size_t numElements, const QualityOutput& output)
+		{
+#if GMSHCOMMON_AVX2
+			if (HasAvx2())
+			{
+				Run(TetrahedronBlockAvx2, x, y, z, connectivity, numElements, output);
+				return;
+			}
+#endif
+			Run(TetrahedronBlock, x, y, z, connectivity, numElements, output);
+		}
+
+		void TriangleQuality(const double* x, const double* y, const double* z, const int* connectivity, size_t numElements, const QualityOutput& output)
+		{
+#if GMSHCOMMON_AVX2
+			if (HasAvx2())
+			{
+				Run(TriangleBlockAvx2, x, y, z, connectivity, numElements, output);
+				return;
+			}
+#endif
+			Run(TriangleBlock, x, y, z, connectivity, numElements, output);
+		}
+	}
+}
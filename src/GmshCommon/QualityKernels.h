@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+// Whether the AVX2 kernels are compiled in. MSVC emits AVX2 intrinsics regardless
+// of /arch; elsewhere the AVX2 path needs -mavx2. HasAvx2 decides at run time.
+#if defined(_MSC_VER) || defined(__AVX2__)
+#define GMSHCOMMON_AVX2 1
+#else
+#define GMSHCOMMON_AVX2 0
+#endif
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Per-element quality measures, one output array entry per element.
+		//   size:        volume (tetrahedra) or area (triangles), unsigned
+		//   gamma:       rms edge length cubed (squared) over volume (area), scaled to 1 for a regular element
+		//   aspectRatio: longest edge over the inradius, scaled to 1 for a regular element
+		//   minEdge, maxEdge
+		//   minAngle:    smallest dihedral angle (tetrahedra) or corner angle (triangles), in degrees
+		struct QualityOutput
+		{
+			double* size;
+			double* gamma;
+			double* aspectRatio;
+			double* minEdge;
+			double* maxEdge;
+			double* minAngle;
+		};
+
+		// Coordinates are given as separate x, y and z arrays; 'connectivity' holds four
+		// (three) zero-based node indices per element. Uses AVX2 when the CPU supports
+		// it and splits the block across the native thread pool.
+		void TetrahedronQuality(const double* x, const double* y, const double* z, const int* connectivity, size_t numElements, const QualityOutput& output);
+		void TriangleQuality(const double* x, const double* y, const double* z, const int* connectivity, size_t numElements, const QualityOutput& output);
+
+		bool HasAvx2();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <utility>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		// Vectors reused by the caller-buffer overloads. They are cleared but not
+		// shrunk, so repeated extraction stops allocating once they have grown;
+		// ReleaseScratch gives the memory back. There is one set per process and no
+		// locking, so the overloads that use it must not run on several threads at once.
+		struct Scratch
+		{
+			std::vector<size_t> elementTags, nodeTags;
+			std::vector<double> coord, parametricCoord, localCoord;
+			std::vector<double> jacobians, determinants;
+		};
+
+		inline Scratch& GetScratch()
+		{
+			static Scratch scratch;
+			return scratch;
+		}
+
+		inline void ReleaseScratch()
+		{
+			Scratch empty;
+			std::swap(GetScratch(), empty);
+		}
+
+		template<typename T, typename U>
+		bool Fits(const std::vector<T>& source, array<U>^ destination)
+		{
+			return destination != nullptr && static_cast<size_t>(destination->Length) >= source.size();
+		}
+
+		// Copies 'source' into the start of 'destination', which must fit it.
+		template<typename T, typename U>
+		void CopyOut(const std::vector<T>& source, array<U>^ destination)
+		{
+			if (source.size() < 1)
+				return;
+
+			pin_ptr<U> pinned = &destination[0];
+			std::memcpy(static_cast<U*>(pinned), source.data(), source.size() * sizeof(T));
+		}
+
+		// Replaces the contents of 'destination' with 'source'; null reads as empty.
+		template<typename T, typename U>
+		void CopyIn(array<U>^ source, std::vector<T>& destination)
+		{
+			static_assert(sizeof(T) == sizeof(U), "Element sizes must match.");
+
+			destination.resize(source == nullptr ? 0 : source->Length);
+			if (destination.size() < 1)
+				return;
+
+			pin_ptr<U> pinned = &source[0];
+			std::memcpy(destination.data(), static_cast<U*>(pinned), destination.size() * sizeof(T));
+		}
+	}
+}
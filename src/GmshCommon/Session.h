@@ -0,0 +1,185 @@
+#pragma once
+
+#include "gmsh.h"
+#include "MeshCache.h"
+#include "OptionProfile.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <msclr\marshal_cppstd.h>
+#include <msclr\lock.h>
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// Shared, reference-counted gmsh session. gmsh is initialized by the first
+	/// Acquire and stays initialized between jobs, so options and plugins are not
+	/// reloaded on every solve. Each job works in its own named model, but options
+	/// are global: a job should set them through ApplyOptions, which restores the
+	/// previous values when its handle is disposed. Options set directly through
+	/// Option stay in effect for later jobs.
+	/// </summary>
+	public ref class Session : System::IDisposable
+	{
+	public:
+		// Takes a reference to the session, initializing gmsh if needed. Dispose the
+		// returned handle when the job is done.
+		static Session^ Acquire()
+		{
+			msclr::lock l(s_lock);
+
+			if (!gmsh::isInitialized())
+			{
+				System::Diagnostics::Stopwatch^ watch = System::Diagnostics::Stopwatch::StartNew();
+				gmsh::initialize();
+				watch->Stop();
+
+				s_initializationTime = watch->Elapsed;
+				++s_initializationCount;
+				MeshCache::ResetInputs();
+
+				gmsh::logger::write("Session initialized in " + std::to_string(watch->Elapsed.TotalMilliseconds) + " ms", "info");
+			}
+
+			++s_referenceCount;
+			return gcnew Session();
+		}
+
+		// Makes model 'name' current, adding it if it does not exist yet. With 'reset'
+		// an existing model is emptied first; other models are left alone.
+		void UseModel(System::String^ name, bool reset)
+		{
+			CheckDisposed();
+			std::string nName = msclr::interop::marshal_as<std::string>(name);
+
+			msclr::lock l(s_lock);
+
+			std::vector<std::string> names;
+			gmsh::model::list(names);
+
+			if (std::find(names.begin(), names.end(), nName) != names.end())
+			{
+				gmsh::model::setCurrent(nName);
+				if (!reset)
+				{
+					MeshCache::InvalidateInputs();
+					return;
+				}
+
+				gmsh::model::remove();
+			}
+
+			gmsh::model::add(nName);
+			MeshCache::ResetInputs();
+		}
+
+		// Empties the current model, keeping its name, the options and the other models.
+		void ResetModel()
+		{
+			CheckDisposed();
+
+			msclr::lock l(s_lock);
+
+			std::string name;
+			gmsh::model::getCurrent(name);
+			gmsh::model::remove();
+			gmsh::model::add(name);
+			MeshCache::ResetInputs();
+		}
+
+		// Applies 'options' for the lifetime of this handle. Their previous values are
+		// restored when the handle is disposed, latest first.
+		void ApplyOptions(OptionProfile^ options)
+		{
+			CheckDisposed();
+			if (options == nullptr) throw gcnew System::ArgumentNullException("options");
+
+			if (m_optionScopes == nullptr)
+				m_optionScopes = gcnew System::Collections::Generic::List<System::IDisposable^>();
+
+			m_optionScopes->Add(options->ApplyScoped());
+		}
+
+		~Session()
+		{
+			if (m_released) return;
+			m_released = true;
+
+			if (m_optionScopes != nullptr)
+			{
+				for (int i = m_optionScopes->Count - 1; i >= 0; --i)
+					delete m_optionScopes[i];
+				m_optionScopes = nullptr;
+			}
+
+			msclr::lock l(s_lock);
+			--s_referenceCount;
+
+			if (s_referenceCount == 0 && !s_keepAlive && gmsh::isInitialized())
+				gmsh::finalize();
+		}
+
+		// gmsh is not called from the finalizer thread: a handle that was never
+		// disposed keeps its reference and its options, and is only reported.
+		!Session()
+		{
+			if (!m_released)
+				System::Diagnostics::Trace::TraceWarning("A gmsh Session handle was not disposed; its reference is never released.");
+		}
+
+		// Finalizes gmsh if no handles are in use. Returns false otherwise.
+		static bool Shutdown()
+		{
+			msclr::lock l(s_lock);
+
+			if (s_referenceCount > 0) return false;
+			if (gmsh::isInitialized()) gmsh::finalize();
+			return true;
+		}
+
+		static property bool IsInitialized
+		{
+			bool get() { return gmsh::isInitialized() != 0; }
+		}
+
+		static property int ReferenceCount
+		{
+			int get() { return s_referenceCount; }
+		}
+
+		// When false, gmsh is finalized as soon as the last handle is released.
+		static property bool KeepAlive
+		{
+			bool get() { return s_keepAlive; }
+			void set(bool value) { s_keepAlive = value; }
+		}
+
+		// Duration of the most recent gmsh::initialize, and how often it has run.
+		static property System::TimeSpan InitializationTime
+		{
+			System::TimeSpan get() { return s_initializationTime; }
+		}
+
+		static property int InitializationCount
+		{
+			int get() { return s_initializationCount; }
+		}
+
+	private:
+		Session() : m_released(false) {}
+
+		void CheckDisposed()
+		{
+			if (m_released) throw gcnew System::ObjectDisposedException("Session");
+		}
+
+		bool m_released;
+		System::Collections::Generic::List<System::IDisposable^>^ m_optionScopes;
+
+		static System::Object^ s_lock = gcnew System::Object();
+		static int s_referenceCount = 0;
+		static int s_initializationCount = 0;
+		static bool s_keepAlive = true;
+		static System::TimeSpan s_initializationTime;
+	};
+}
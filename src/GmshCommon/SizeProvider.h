@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <msclr\marshal_cppstd.h>
+
+#include "ElementBvh.h"
+#include "SizeProviders.h"
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// A mesh size function that runs in native code, for Gmsh.Model.Mesh.SetSizeCallback.
+	/// Unlike a MeshSizeCallback delegate it never calls back into .NET and is safe to
+	/// query from gmsh's meshing threads.
+	/// </summary>
+	public ref class SizeProvider : System::IDisposable
+	{
+	public:
+		// Analytic expression of x, y, z, lc, dim and tag; see SizeProviders.h for the syntax.
+		static SizeProvider^ Expression(System::String^ expression)
+		{
+			if (expression == nullptr) throw gcnew System::ArgumentNullException("expression");
+
+			std::string text = msclr::interop::marshal_as<std::string>(expression);
+			try
+			{
+				return gcnew SizeProvider(Native::CompileExpression(text));
+			}
+			catch (const std::exception& e)
+			{
+				throw gcnew System::ArgumentException(gcnew System::String(e.what()));
+			}
+		}
+
+		// Size sizeMin within distMin of the nearest of 'points' (xyz triplets), sizeMax
+		// beyond distMax and linear in between.
+		static SizeProvider^ Attractors(array<double>^ points, double sizeMin, double sizeMax, double distMin, double distMax)
+		{
+			if (points == nullptr) throw gcnew System::ArgumentNullException("points");
+
+			pin_ptr<double> pPoints = points->Length > 0 ? &points[0] : nullptr;
+			return gcnew SizeProvider(Native::CreateAttractors(pPoints, points->Length / 3, sizeMin, sizeMax, distMin, distMax));
+		}
+
+		// Sizes given at the nodes of a background mesh of linear triangles, tetrahedra
+		// or hexahedra (coords as xyz triplets, zero-based connectivity), interpolated
+		// inside its elements. Outside the background mesh the current size is kept.
+		static SizeProvider^ Sampled(array<double>^ coords, array<int>^ connectivity, int nodesPerElement, array<double>^ nodalSizes)
+		{
+			if (coords == nullptr || connectivity == nullptr || nodalSizes == nullptr) throw gcnew System::ArgumentNullException();
+			if (nodesPerElement < 1 || connectivity->Length % nodesPerElement != 0)
+				throw gcnew System::ArgumentException("Connectivity length is not a multiple of the nodes per element.");
+
+			pin_ptr<double> pCoords = coords->Length > 0 ? &coords[0] : nullptr;
+			pin_ptr<int> pConnectivity = connectivity->Length > 0 ? &connectivity[0] : nullptr;
+
+			std::vector<double> sizes(nodalSizes->Length);
+			if (sizes.size() > 0)
+				Marshal::Copy(nodalSizes, 0, IntPtr(sizes.data()), nodalSizes->Length);
+
+			try
+			{
+				std::shared_ptr<const Native::ElementBvh> bvh = std::make_shared<const Native::ElementBvh>(
+					pCoords, coords->Length / 3, pConnectivity, connectivity->Length / nodesPerElement, nodesPerElement, 1e-9);
+
+				return gcnew SizeProvider(Native::CreateSampled(bvh, sizes));
+			}
+			catch (const std::exception& e)
+			{
+				throw gcnew System::ArgumentException(gcnew System::String(e.what()));
+			}
+		}
+
+		// Sizes on a regular dims[0] x dims[1] x dims[2] grid of points starting at 'origin'
+		// and 'spacing' apart, x varying fastest in 'values', copied in one block.
+		// Trilinear inside the grid, nearest boundary value outside it.
+		static SizeProvider^ Grid(array<double>^ origin, array<double>^ spacing, array<int>^ dims, array<double>^ values)
+		{
+			if (origin == nullptr || spacing == nullptr || dims == nullptr || values == nullptr) throw gcnew System::ArgumentNullException();
+			if (origin->Length != 3 || spacing->Length != 3 || dims->Length != 3)
+				throw gcnew System::ArgumentException("Origin, spacing and dims must have three entries.");
+
+			double nOrigin[3] = { origin[0], origin[1], origin[2] };
+			double nSpacing[3] = { spacing[0], spacing[1], spacing[2] };
+			int nDims[3] = { dims[0], dims[1], dims[2] };
+
+			std::vector<double> nValues(values->Length);
+			if (nValues.size() > 0)
+				Marshal::Copy(values, 0, IntPtr(nValues.data()), values->Length);
+
+			try
+			{
+				return gcnew SizeProvider(Native::CreateGrid(nOrigin, nSpacing, nDims, nValues));
+			}
+			catch (const std::exception& e)
+			{
+				throw gcnew System::ArgumentException(gcnew System::String(e.what()));
+			}
+		}
+
+		// The smallest size of several providers.
+		static SizeProvider^ Min(... array<SizeProvider^>^ providers)
+		{
+			if (providers == nullptr) throw gcnew System::ArgumentNullException("providers");
+
+			std::vector<Native::SizeProviderPtr> natives;
+			for (int i = 0; i < providers->Length; ++i)
+				natives.push_back(providers[i]->Provider);
+
+			return gcnew SizeProvider(Native::CreateMinimum(natives));
+		}
+
+		// Evaluates the provider, mainly for checking it before meshing.
+		double Evaluate(int dim, int tag, double x, double y, double z, double lc)
+		{
+			return Provider->Size(dim, tag, x, y, z, lc);
+		}
+
+		~SizeProvider()
+		{
+			this->!SizeProvider();
+		}
+
+		!SizeProvider()
+		{
+			delete m_provider;
+			m_provider = nullptr;
+		}
+
+	internal:
+		property Native::SizeProviderPtr Provider
+		{
+			Native::SizeProviderPtr get()
+			{
+				if (m_provider == nullptr) throw gcnew System::ObjectDisposedException("SizeProvider");
+				return *m_provider;
+			}
+		}
+
+	private:
+		SizeProvider(const Native::SizeProviderPtr& provider) : m_provider(new Native::SizeProviderPtr(provider)) {}
+
+		Native::SizeProviderPtr* m_provider;
+	};
+}
@@ -0,0 +1,579 @@
+// Compiled as native code.
+#include "SizeProviders.h"
+#include "ElementBvh.h"
+#include "FieldTransfer.h"
+
+#include "gmsh.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			// Expressions compile to a small stack machine
+
+			enum class OpCode { Constant, Variable, Add, Subtract, Multiply, Divide, Power, Negate, Call1, Call2 };
+
+			typedef double (*Function1)(double);
+			typedef double (*Function2)(double, double);
+
+			struct Instruction
+			{
+				OpCode code;
+				double value;		// Constant
+				int index;			// Variable
+				Function1 f1;
+				Function2 f2;
+			};
+
+			double Min(double a, double b) { return a < b ? a : b; }
+			double Max(double a, double b) { return a > b ? a : b; }
+			double Pow(double a, double b) { return std::pow(a, b); }
+			double Atan2(double a, double b) { return std::atan2(a, b); }
+			double Sqrt(double a) { return std::sqrt(a); }
+			double Abs(double a) { return std::abs(a); }
+			double Exp(double a) { return std::exp(a); }
+			double Log(double a) { return std::log(a); }
+			double Sin(double a) { return std::sin(a); }
+			double Cos(double a) { return std::cos(a); }
+			double Tan(double a) { return std::tan(a); }
+			double Asin(double a) { return std::asin(a); }
+			double Acos(double a) { return std::acos(a); }
+			double Atan(double a) { return std::atan(a); }
+			double Sinh(double a) { return std::sinh(a); }
+			double Cosh(double a) { return std::cosh(a); }
+			double Tanh(double a) { return std::tanh(a); }
+			double Floor(double a) { return std::floor(a); }
+			double Ceil(double a) { return std::ceil(a); }
+
+			struct NamedFunction1 { const char* name; Function1 f; };
+			struct NamedFunction2 { const char* name; Function2 f; };
+
+			const NamedFunction1 Functions1[] = {
+				{ "sqrt", Sqrt }, { "abs", Abs }, { "exp", Exp }, { "log", Log },
+				{ "sin", Sin }, { "cos", Cos }, { "tan", Tan }, { "asin", Asin }, { "acos", Acos }, { "atan", Atan },
+				{ "sinh", Sinh }, { "cosh", Cosh }, { "tanh", Tanh }, { "floor", Floor }, { "ceil", Ceil } };
+
+			const NamedFunction2 Functions2[] = {
+				{ "min", Min }, { "max", Max }, { "pow", Pow }, { "atan2", Atan2 } };
+
+			// Variable order matches the arguments of Size()
+			const char* const Variables[] = { "x", "y", "z", "lc", "dim", "tag" };
+
+			const int MaxStackDepth = 64;
+
+			class Parser
+			{
+			public:
+				Parser(const std::string& text) : m_text(text), m_position(0), m_depth(0), m_maxDepth(0) {}
+
+				std::vector<Instruction> Parse(int& maxDepth)
+				{
+					Expression();
+					SkipSpace();
+					if (m_position != m_text.size()) Fail("unexpected character");
+
+					maxDepth = m_maxDepth;
+					return m_code;
+				}
+
+			private:
+				void Fail(const char* message)
+				{
+					throw std::invalid_argument(std::string("Invalid size expression: ") + message + " at position " + std::to_string(m_position) + ".");
+				}
+
+				void SkipSpace()
+				{
+					while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position]))) ++m_position;
+				}
+
+				bool Accept(char c)
+				{
+					SkipSpace();
+					if (m_position < m_text.size() && m_text[m_position] == c)
+					{
+						++m_position;
+						return true;
+					}
+					return false;
+				}
+
+				void Emit(OpCode code, int stackChange)
+				{
+					Instruction instruction = { code, 0.0, 0, nullptr, nullptr };
+					m_code.push_back(instruction);
+
+					m_depth += stackChange;
+					m_maxDepth = std::max(m_maxDepth, m_depth);
+					if (m_maxDepth > MaxStackDepth) Fail("expression too deeply nested");
+				}
+
+				void Expression()
+				{
+					Term();
+					for (;;)
+					{
+						if (Accept('+')) { Term(); Emit(OpCode::Add, -1); }
+						else if (Accept('-')) { Term(); Emit(OpCode::Subtract, -1); }
+						else break;
+					}
+				}
+
+				void Term()
+				{
+					Unary();
+					for (;;)
+					{
+						if (Accept('*')) { Unary(); Emit(OpCode::Multiply, -1); }
+						else if (Accept('/')) { Unary(); Emit(OpCode::Divide, -1); }
+						else break;
+					}
+				}
+
+				void Unary()
+				{
+					if (Accept('-')) { Unary(); Emit(OpCode::Negate, 0); }
+					else if (Accept('+')) Unary();
+					else Power();
+				}
+
+				// Right associative, binds tighter than unary minus on its left: -x^2 = -(x^2)
+				void Power()
+				{
+					Primary();
+					if (Accept('^')) { Unary(); Emit(OpCode::Power, -1); }
+				}
+
+				void Primary()
+				{
+					SkipSpace();
+					if (m_position >= m_text.size()) Fail("unexpected end");
+
+					char c = m_text[m_position];
+					if (Accept('('))
+					{
+						Expression();
+						if (!Accept(')')) Fail("expected ')'");
+					}
+					else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+					{
+						const char* begin = m_text.c_str() + m_position;
+						char* end;
+						double value = std::strtod(begin, &end);
+						if (end == begin) Fail("invalid number");
+						m_position += end - begin;
+
+						Emit(OpCode::Constant, 1);
+						m_code.back().value = value;
+					}
+					else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+					{
+						size_t start = m_position;
+						while (m_position < m_text.size() && (std::isalnum(static_cast<unsigned char>(m_text[m_position])) || m_text[m_position] == '_')) ++m_position;
+						std::string name = m_text.substr(start, m_position - start);
+
+						if (Accept('('))
+							Call(name);
+						else
+							Name(name);
+					}
+					else
+						Fail("unexpected character");
+				}
+
+				void Name(const std::string& name)
+				{
+					if (name == "pi")
+					{
+						Emit(OpCode::Constant, 1);
+						m_code.back().value = 3.14159265358979323846;
+						return;
+					}
+
+					for (int i = 0; i < 6; ++i)
+					{
+						if (name == Variables[i])
+						{
+							Emit(OpCode::Variable, 1);
+							m_code.back().index = i;
+							return;
+						}
+					}
+
+					Fail(("unknown variable '" + name + "'").c_str());
+				}
+
+				void Call(const std::string& name)
+				{
+					for (const NamedFunction1& f : Functions1)
+					{
+						if (name != f.name) continue;
+
+						Expression();
+						if (!Accept(')')) Fail("expected ')'");
+
+						Emit(OpCode::Call1, 0);
+						m_code.back().f1 = f.f;
+						return;
+					}
+
+					for (const NamedFunction2& f : Functions2)
+					{
+						if (name != f.name) continue;
+
+						Expression();
+						if (!Accept(',')) Fail("expected ','");
+						Expression();
+						if (!Accept(')')) Fail("expected ')'");
+
+						Emit(OpCode::Call2, -1);
+						m_code.back().f2 = f.f;
+						return;
+					}
+
+					Fail(("unknown function '" + name + "'").c_str());
+				}
+
+				const std::string& m_text;
+				size_t m_position;
+				int m_depth, m_maxDepth;
+				std::vector<Instruction> m_code;
+			};
+
+			class ExpressionSize : public SizeProvider
+			{
+			public:
+				ExpressionSize(const std::string& expression)
+				{
+					int maxDepth;
+					m_code = Parser(expression).Parse(maxDepth);
+				}
+
+				double Size(int dim, int tag, double x, double y, double z, double lc) const override
+				{
+					const double variables[6] = { x, y, z, lc, static_cast<double>(dim), static_cast<double>(tag) };
+
+					// The depth was bounded at compile time, so the stack lives on the caller's frame
+					double stack[MaxStackDepth];
+					int top = 0;
+
+					for (const Instruction& op : m_code)
+					{
+						switch (op.code)
+						{
+						case OpCode::Constant: stack[top++] = op.value; break;
+						case OpCode::Variable: stack[top++] = variables[op.index]; break;
+						case OpCode::Add: --top; stack[top - 1] += stack[top]; break;
+						case OpCode::Subtract: --top; stack[top - 1] -= stack[top]; break;
+						case OpCode::Multiply: --top; stack[top - 1] *= stack[top]; break;
+						case OpCode::Divide: --top; stack[top - 1] /= stack[top]; break;
+						case OpCode::Power: --top; stack[top - 1] = std::pow(stack[top - 1], stack[top]); break;
+						case OpCode::Negate: stack[top - 1] = -stack[top - 1]; break;
+						case OpCode::Call1: stack[top - 1] = op.f1(stack[top - 1]); break;
+						case OpCode::Call2: --top; stack[top - 1] = op.f2(stack[top - 1], stack[top]); break;
+						}
+					}
+
+					return stack[0];
+				}
+
+			private:
+				std::vector<Instruction> m_code;
+			};
+
+			// Attractor points bucketed in a uniform grid so a query only visits the cells
+			// within distMax of it.
+			class AttractorSize : public SizeProvider
+			{
+			public:
+				AttractorSize(const double* points, size_t numPoints, double sizeMin, double sizeMax, double distMin, double distMax)
+					: m_sizeMin(sizeMin), m_sizeMax(sizeMax), m_distMin(std::max(0.0, distMin)), m_distMax(std::max(m_distMin, distMax))
+				{
+					if (numPoints < 1) return;
+
+					for (int k = 0; k < 3; ++k)
+					{
+						m_min[k] = std::numeric_limits<double>::max();
+						double max = std::numeric_limits<double>::lowest();
+						for (size_t i = 0; i < numPoints; ++i)
+						{
+							m_min[k] = std::min(m_min[k], points[i * 3 + k]);
+							max = std::max(max, points[i * 3 + k]);
+						}
+						m_extent[k] = max - m_min[k];
+					}
+
+					// Cells of size distMax, coarsened while there are many more cells than points
+					m_cellSize = m_distMax > 0 ? m_distMax : std::max(m_extent[0], std::max(m_extent[1], m_extent[2]));
+					if (m_cellSize <= 0) m_cellSize = 1;
+					for (;;)
+					{
+						double cells = 1;
+						for (int k = 0; k < 3; ++k)
+							cells *= std::floor(m_extent[k] / m_cellSize) + 1;
+						if (cells <= 8.0 * numPoints + 64) break;
+						m_cellSize *= 2;
+					}
+
+					for (int k = 0; k < 3; ++k)
+						m_dims[k] = static_cast<int>(std::floor(m_extent[k] / m_cellSize)) + 1;
+
+					size_t numCells = static_cast<size_t>(m_dims[0]) * m_dims[1] * m_dims[2];
+					std::vector<size_t> cellOf(numPoints);
+					m_cellStart.assign(numCells + 1, 0);
+					for (size_t i = 0; i < numPoints; ++i)
+					{
+						int c[3];
+						for (int k = 0; k < 3; ++k)
+							c[k] = std::min(m_dims[k] - 1, static_cast<int>((points[i * 3 + k] - m_min[k]) / m_cellSize));
+						cellOf[i] = Cell(c);
+						++m_cellStart[cellOf[i] + 1];
+					}
+
+					for (size_t i = 0; i < numCells; ++i)
+						m_cellStart[i + 1] += m_cellStart[i];
+
+					std::vector<size_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+					m_points.resize(numPoints * 3);
+					for (size_t i = 0; i < numPoints; ++i)
+					{
+						size_t j = fill[cellOf[i]]++;
+						m_points[j * 3] = points[i * 3];
+						m_points[j * 3 + 1] = points[i * 3 + 1];
+						m_points[j * 3 + 2] = points[i * 3 + 2];
+					}
+				}
+
+				double Size(int, int, double x, double y, double z, double) const override
+				{
+					if (m_points.empty()) return m_sizeMax;
+
+					double p[3] = { x, y, z };
+					int low[3], high[3];
+					for (int k = 0; k < 3; ++k)
+					{
+						double lowCell = std::floor((p[k] - m_distMax - m_min[k]) / m_cellSize);
+						double highCell = std::floor((p[k] + m_distMax - m_min[k]) / m_cellSize);
+						if (highCell < 0 || lowCell > m_dims[k] - 1) return m_sizeMax;
+
+						low[k] = static_cast<int>(std::max(0.0, lowCell));
+						high[k] = static_cast<int>(std::min(static_cast<double>(m_dims[k] - 1), highCell));
+					}
+
+					double best = m_distMax * m_distMax;
+					bool any = false;
+
+					int c[3];
+					for (c[2] = low[2]; c[2] <= high[2]; ++c[2])
+						for (c[1] = low[1]; c[1] <= high[1]; ++c[1])
+							for (c[0] = low[0]; c[0] <= high[0]; ++c[0])
+							{
+								size_t cell = Cell(c);
+								for (size_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+								{
+									double dx = m_points[i * 3] - x, dy = m_points[i * 3 + 1] - y, dz = m_points[i * 3 + 2] - z;
+									double d2 = dx * dx + dy * dy + dz * dz;
+									if (d2 <= best)
+									{
+										best = d2;
+										any = true;
+									}
+								}
+							}
+
+					if (!any) return m_sizeMax;
+
+					double d = std::sqrt(best);
+					if (d <= m_distMin) return m_sizeMin;
+					if (d >= m_distMax) return m_sizeMax;
+
+					return m_sizeMin + (m_sizeMax - m_sizeMin) * (d - m_distMin) / (m_distMax - m_distMin);
+				}
+
+			private:
+				size_t Cell(const int* c) const
+				{
+					return (static_cast<size_t>(c[2]) * m_dims[1] + c[1]) * m_dims[0] + c[0];
+				}
+
+				double m_sizeMin, m_sizeMax, m_distMin, m_distMax;
+				double m_min[3], m_extent[3], m_cellSize;
+				int m_dims[3];
+				std::vector<size_t> m_cellStart;
+				std::vector<double> m_points;
+			};
+
+			class SampledSize : public SizeProvider
+			{
+			public:
+				SampledSize(const std::shared_ptr<const ElementBvh>& bvh, std::vector<double>& nodalSizes) : m_bvh(bvh)
+				{
+					m_sizes.swap(nodalSizes);
+				}
+
+				double Size(int, int, double x, double y, double z, double lc) const override
+				{
+					double point[3] = { x, y, z }, local[3], weights[8];
+					int element = m_bvh->Locate(point, local);
+					if (element < 0) return lc;
+
+					int n = m_bvh->NodesPerElement();
+					ShapeFunctions(n, local, weights);
+
+					const int* nodes = m_bvh->Connectivity().data() + static_cast<size_t>(element) * n;
+					double size = 0;
+					for (int i = 0; i < n; ++i)
+						size += weights[i] * m_sizes[nodes[i]];
+
+					return size;
+				}
+
+			private:
+				std::shared_ptr<const ElementBvh> m_bvh;
+				std::vector<double> m_sizes;
+			};
+
+			class GridSize : public SizeProvider
+			{
+			public:
+				GridSize(const double* origin, const double* spacing, const int* dims, std::vector<double>& values)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						if (dims[k] < 1) throw std::invalid_argument("Grid dimensions must be positive.");
+						if (!(spacing[k] > 0)) throw std::invalid_argument("Grid spacing must be positive.");
+
+						m_origin[k] = origin[k];
+						m_inverseSpacing[k] = 1.0 / spacing[k];
+						m_dims[k] = dims[k];
+					}
+
+					if (values.size() != static_cast<size_t>(dims[0]) * dims[1] * dims[2])
+						throw std::invalid_argument("Expected dims[0] * dims[1] * dims[2] grid values.");
+
+					m_strideY = static_cast<size_t>(dims[0]);
+					m_strideZ = m_strideY * dims[1];
+					m_values.swap(values);
+				}
+
+				double Size(int, int, double x, double y, double z, double) const override
+				{
+					double p[3] = { x, y, z };
+					size_t cell[3];
+					double t[3];
+					size_t step[3];
+
+					for (int k = 0; k < 3; ++k)
+					{
+						double g = (p[k] - m_origin[k]) * m_inverseSpacing[k];
+						double last = static_cast<double>(m_dims[k] - 1);
+						g = g < 0 ? 0 : (g > last ? last : g);
+
+						// The last cell is used for points on the upper boundary
+						size_t i = static_cast<size_t>(g);
+						if (m_dims[k] > 1 && i == static_cast<size_t>(m_dims[k] - 1)) --i;
+
+						cell[k] = i;
+						t[k] = g - static_cast<double>(i);
+					}
+
+					step[0] = m_dims[0] > 1 ? 1 : 0;
+					step[1] = m_dims[1] > 1 ? m_strideY : 0;
+					step[2] = m_dims[2] > 1 ? m_strideZ : 0;
+
+					// Four rows of two adjacent values each
+					const double* v = m_values.data() + cell[0] + cell[1] * m_strideY + cell[2] * m_strideZ;
+					const double* v01 = v + step[1];
+					const double* v10 = v + step[2];
+					const double* v11 = v10 + step[1];
+
+					double c00 = v[0] + (v[step[0]] - v[0]) * t[0];
+					double c01 = v01[0] + (v01[step[0]] - v01[0]) * t[0];
+					double c10 = v10[0] + (v10[step[0]] - v10[0]) * t[0];
+					double c11 = v11[0] + (v11[step[0]] - v11[0]) * t[0];
+
+					double c0 = c00 + (c01 - c00) * t[1];
+					double c1 = c10 + (c11 - c10) * t[1];
+
+					return c0 + (c1 - c0) * t[2];
+				}
+
+			private:
+				double m_origin[3], m_inverseSpacing[3];
+				int m_dims[3];
+				size_t m_strideY, m_strideZ;
+				std::vector<double> m_values;
+			};
+
+			class MinimumSize : public SizeProvider
+			{
+			public:
+				MinimumSize(const std::vector<SizeProviderPtr>& providers) : m_providers(providers) {}
+
+				double Size(int dim, int tag, double x, double y, double z, double lc) const override
+				{
+					double size = std::numeric_limits<double>::max();
+					for (const SizeProviderPtr& provider : m_providers)
+						size = std::min(size, provider->Size(dim, tag, x, y, z, lc));
+
+					return size;
+				}
+
+			private:
+				std::vector<SizeProviderPtr> m_providers;
+			};
+		}
+
+		SizeProviderPtr CompileExpression(const std::string& expression)
+		{
+			return std::make_shared<ExpressionSize>(expression);
+		}
+
+		SizeProviderPtr CreateAttractors(const double* points, size_t numPoints, double sizeMin, double sizeMax, double distMin, double distMax)
+		{
+			return std::make_shared<AttractorSize>(points, numPoints, sizeMin, sizeMax, distMin, distMax);
+		}
+
+		SizeProviderPtr CreateSampled(const std::shared_ptr<const ElementBvh>& bvh, std::vector<double>& nodalSizes)
+		{
+			if (nodalSizes.size() != bvh->Coords().size() / 3)
+				throw std::invalid_argument("Expected one size per background mesh node.");
+
+			return std::make_shared<SampledSize>(bvh, nodalSizes);
+		}
+
+		SizeProviderPtr CreateGrid(const double* origin, const double* spacing, const int* dims, std::vector<double>& values)
+		{
+			return std::make_shared<GridSize>(origin, spacing, dims, values);
+		}
+
+		SizeProviderPtr CreateMinimum(const std::vector<SizeProviderPtr>& providers)
+		{
+			return std::make_shared<MinimumSize>(providers);
+		}
+
+		void SetSizeProvider(const SizeProviderPtr& provider, bool limitToCurrent)
+		{
+			// gmsh keeps a copy of the callback, which holds the provider alive
+			if (limitToCurrent)
+				gmsh::model::mesh::setSizeCallback([provider](int dim, int tag, double x, double y, double z, double lc)
+					{
+						return std::min(lc, provider->Size(dim, tag, x, y, z, lc));
+					});
+			else
+				gmsh::model::mesh::setSizeCallback([provider](int dim, int tag, double x, double y, double z, double lc)
+					{
+						return provider->Size(dim, tag, x, y, z, lc);
+					});
+		}
+	}
+}
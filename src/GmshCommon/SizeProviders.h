@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		class ElementBvh;
+
+		// A mesh size function evaluated entirely in native code. Implementations are
+		// immutable once built, so gmsh may query them from several meshing threads.
+		class SizeProvider
+		{
+		public:
+			virtual ~SizeProvider() {}
+			virtual double Size(int dim, int tag, double x, double y, double z, double lc) const = 0;
+		};
+
+		typedef std::shared_ptr<const SizeProvider> SizeProviderPtr;
+
+		// Compiles an analytic expression of x, y, z, lc, dim and tag, e.g.
+		// "min(lc, 0.1 + 0.05 * sqrt(x^2 + y^2))". Supports + - * / ^, parentheses,
+		// pi, and the functions sqrt abs exp log sin cos tan asin acos atan sinh cosh
+		// tanh floor ceil (one argument) and min max pow atan2 (two arguments).
+		// Throws std::invalid_argument on syntax errors.
+		SizeProviderPtr CompileExpression(const std::string& expression);
+
+		// Point attractors with the Threshold profile of gmsh: sizeMin up to distMin
+		// from the nearest point, sizeMax from distMax, linear in between.
+		SizeProviderPtr CreateAttractors(const double* points, size_t numPoints, double sizeMin, double sizeMax, double distMin, double distMax);
+
+		// Sizes sampled at the nodes of a background mesh and interpolated within its
+		// elements. Outside the mesh the current size lc is kept.
+		SizeProviderPtr CreateSampled(const std::shared_ptr<const ElementBvh>& bvh, std::vector<double>& nodalSizes);
+
+		// Sizes on a regular grid of dims[0] x dims[1] x dims[2] points starting at
+		// 'origin', 'spacing' apart, with x varying fastest in 'values'. Trilinear inside
+		// the grid; outside it the nearest boundary value is used.
+		SizeProviderPtr CreateGrid(const double* origin, const double* spacing, const int* dims, std::vector<double>& values);
+
+		// Smallest size of several providers.
+		SizeProviderPtr CreateMinimum(const std::vector<SizeProviderPtr>& providers);
+
+		// Installs 'provider' as the mesh size callback of the current model. With
+		// 'limitToCurrent' the result never exceeds the size gmsh would otherwise use.
+		void SetSizeProvider(const SizeProviderPtr& provider, bool limitToCurrent);
+	}
+}
@@ -0,0 +1,205 @@
+// Compiled as native code.
+#include "TetraShell.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		namespace {
+
+			// Local faces of a tetrahedron (a, b, c, d) and the vertex opposite each one.
+			const int FaceVertices[4][4] = {
+				{ 0, 1, 2, 3 },
+				{ 1, 2, 3, 0 },
+				{ 2, 3, 0, 1 },
+				{ 3, 0, 1, 2 } };
+
+			const int KeyBits = 21;
+
+			inline double DistanceSquared(const double* a, const double* b)
+			{
+				double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+				return dx * dx + dy * dy + dz * dz;
+			}
+
+			// Signed volume times six of (a, b, c, d).
+			inline double Orient(const double* a, const double* b, const double* c, const double* d)
+			{
+				double ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+				double vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+				double wx = d[0] - a[0], wy = d[1] - a[1], wz = d[2] - a[2];
+
+				return wx * (uy * vz - uz * vy) + wy * (uz * vx - ux * vz) + wz * (ux * vy - uy * vx);
+			}
+
+			inline void Sort3(uint32_t& a, uint32_t& b, uint32_t& c)
+			{
+				if (a > b) std::swap(a, b);
+				if (b > c) std::swap(b, c);
+				if (a > b) std::swap(a, b);
+			}
+
+			// LSD radix sort of (key, value) pairs on 16-bit digits. Digits that are the
+			// same for every key are skipped.
+			void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values)
+			{
+				const size_t n = keys.size();
+				std::vector<uint64_t> keysTemp(n);
+				std::vector<uint32_t> valuesTemp(n);
+				std::vector<size_t> counts(4 * 65536, 0);
+
+				for (size_t i = 0; i < n; ++i)
+					for (int d = 0; d < 4; ++d)
+						++counts[d * 65536 + ((keys[i] >> (16 * d)) & 0xFFFF)];
+
+				for (int d = 0; d < 4; ++d)
+				{
+					size_t* count = &counts[d * 65536];
+					if (count[(keys[0] >> (16 * d)) & 0xFFFF] == n) continue;
+
+					size_t sum = 0;
+					for (int j = 0; j < 65536; ++j)
+					{
+						size_t c = count[j];
+						count[j] = sum;
+						sum += c;
+					}
+
+					for (size_t i = 0; i < n; ++i)
+					{
+						size_t slot = count[(keys[i] >> (16 * d)) & 0xFFFF]++;
+						keysTemp[slot] = keys[i];
+						valuesTemp[slot] = values[i];
+					}
+
+					keys.swap(keysTemp);
+					values.swap(valuesTemp);
+				}
+			}
+
+			void EmitFace(const double* coords, const std::vector<int>& tetra, uint32_t face, std::vector<int>& triangles)
+			{
+				const int* tet = &tetra[(face >> 2) * 4];
+				const int* local = FaceVertices[face & 3];
+
+				int a = tet[local[0]], b = tet[local[1]], c = tet[local[2]], d = tet[local[3]];
+				if (Orient(coords + a * 3, coords + b * 3, coords + c * 3, coords + d * 3) > 0)
+					std::swap(b, c);
+
+				triangles.push_back(a);
+				triangles.push_back(b);
+				triangles.push_back(c);
+			}
+		}
+
+		void FilterTetrahedra(const double* coords, const std::vector<int>& tetra, const TetraFilter& filter, std::vector<int>& kept)
+		{
+			kept.clear();
+			kept.reserve(tetra.size());
+
+			const double maxEdgeSquared = filter.maxEdgeLength * filter.maxEdgeLength;
+
+			for (size_t i = 0; i + 3 < tetra.size(); i += 4)
+			{
+				const double* a = coords + tetra[i] * 3;
+				const double* b = coords + tetra[i + 1] * 3;
+				const double* c = coords + tetra[i + 2] * 3;
+				const double* d = coords + tetra[i + 3] * 3;
+
+				double ab = DistanceSquared(a, b), ac = DistanceSquared(a, c), ad = DistanceSquared(a, d);
+				double bc = DistanceSquared(b, c), bd = DistanceSquared(b, d), cd = DistanceSquared(c, d);
+
+				if (filter.maxEdgeLength > 0)
+				{
+					double maxEdge = std::max(std::max(std::max(ab, ac), std::max(ad, bc)), std::max(bd, cd));
+					if (maxEdge > maxEdgeSquared) continue;
+				}
+
+				double volume = std::abs(Orient(a, b, c, d)) / 6;
+				if (volume < filter.minVolume) continue;
+
+				if (filter.maxGamma > 0)
+				{
+					double srms = std::sqrt((ab + ac + ad + bc + bd + cd) / 6);
+					double gamma = srms * srms * srms / (8.479670 * volume);
+					if (gamma > filter.maxGamma) continue;
+				}
+
+				kept.insert(kept.end(), tetra.begin() + i, tetra.begin() + i + 4);
+			}
+		}
+
+		void GetBoundaryFaces(const double* coords, size_t numPoints, const std::vector<int>& tetra, std::vector<int>& triangles)
+		{
+			triangles.clear();
+
+			const size_t numFaces = (tetra.size() / 4) * 4;
+			if (numFaces < 1) return;
+
+			if (numPoints < (size_t(1) << KeyBits))
+			{
+				// Sorted vertex triple packed into one 63-bit key, with the face index
+				// (tetrahedron * 4 + local face) carried alongside.
+				std::vector<uint64_t> keys(numFaces);
+				std::vector<uint32_t> faces(numFaces);
+
+				for (size_t f = 0; f < numFaces; ++f)
+				{
+					const int* tet = &tetra[(f >> 2) * 4];
+					const int* local = FaceVertices[f & 3];
+
+					uint32_t a = tet[local[0]], b = tet[local[1]], c = tet[local[2]];
+					Sort3(a, b, c);
+
+					keys[f] = (uint64_t(a) << (2 * KeyBits)) | (uint64_t(b) << KeyBits) | uint64_t(c);
+					faces[f] = static_cast<uint32_t>(f);
+				}
+
+				RadixSort(keys, faces);
+
+				for (size_t i = 0; i < numFaces;)
+				{
+					size_t j = i + 1;
+					while (j < numFaces && keys[j] == keys[i]) ++j;
+
+					if (j - i == 1)
+						EmitFace(coords, tetra, faces[i], triangles);
+					i = j;
+				}
+			}
+			else
+			{
+				typedef std::array<uint32_t, 4> Record;
+				std::vector<Record> records(numFaces);
+
+				for (size_t f = 0; f < numFaces; ++f)
+				{
+					const int* tet = &tetra[(f >> 2) * 4];
+					const int* local = FaceVertices[f & 3];
+
+					Record& r = records[f];
+					r[0] = tet[local[0]]; r[1] = tet[local[1]]; r[2] = tet[local[2]];
+					Sort3(r[0], r[1], r[2]);
+					r[3] = static_cast<uint32_t>(f);
+				}
+
+				std::sort(records.begin(), records.end());
+
+				for (size_t i = 0; i < numFaces;)
+				{
+					size_t j = i + 1;
+					while (j < numFaces && records[j][0] == records[i][0] && records[j][1] == records[i][1] && records[j][2] == records[i][2]) ++j;
+
+					if (j - i == 1)
+						EmitFace(coords, tetra, records[i][3], triangles);
+					i = j;
+				}
+			}
+		}
+	}
+}
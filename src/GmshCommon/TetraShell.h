@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace GmshCommon {
+
+	namespace Native {
+
+		struct TetraFilter
+		{
+			double maxEdgeLength;	// <= 0 disables the test
+			double minVolume;
+			double maxGamma;		// <= 0 disables the test
+		};
+
+		// Keeps the tetrahedra of 'tetra' (four zero-based point indices each) that pass
+		// 'filter'. 'coords' holds the points as xyz triplets.
+		void FilterTetrahedra(const double* coords, const std::vector<int>& tetra, const TetraFilter& filter, std::vector<int>& kept);
+
+		// Faces that belong to exactly one tetrahedron, as zero-based triangles wound so
+		// that their normals point away from the tetrahedron they bound.
+		void GetBoundaryFaces(const double* coords, size_t numPoints, const std::vector<int>& tetra, std::vector<int>& triangles);
+	}
+}
@@ -3,6 +3,10 @@
 #include "gmsh.h"
 #include <msclr\marshal_cppstd.h>
 
+#include "Centroids.h"
+#include "QualityKernels.h"
+#include "MeshBlock.h"
+
 using System::IntPtr;
 using System::Runtime::InteropServices::Marshal;
 
@@ -38,6 +42,195 @@ namespace GmshCommon {
 
 			return gcnew array<double> { x, y, z };
 		}
+
+		static array<double>^ GetCentroids(int dim, int tag)
+		{
+			return GetCentroids(dim, tag, -1, 0);
+		}
+
+		// Centroids of all elements of 'elementType' (every type of dimension 'dim' if
+		// elementType < 0) on entity 'tag', as one flat xyz buffer ordered by element
+		// type, then by element as returned by GetElements. numTasks < 1 uses all cores.
+		static array<double>^ GetCentroids(int dim, int tag, int elementType, int numTasks)
+		{
+			size_t nNumTasks = numTasks < 1 ? 0 : static_cast<size_t>(numTasks);
+
+			std::vector<int> types;
+			if (elementType < 0)
+				gmsh::model::mesh::getElementTypes(types, dim, tag);
+			else
+				types.push_back(elementType);
+
+			std::vector<std::vector<double>> centroids(types.size());
+			size_t total = 0;
+			for (int i = 0; i < types.size(); ++i)
+			{
+				Native::GetCentroids(types[i], tag, centroids[i], nNumTasks);
+				total += centroids[i].size();
+			}
+
+			array<double>^ output = gcnew array<double>(static_cast<int>(total));
+
+			int offset = 0;
+			for (int i = 0; i < centroids.size(); ++i)
+			{
+				if (centroids[i].size() < 1) continue;
+
+				Marshal::Copy(IntPtr(centroids[i].data()), output, offset, static_cast<int>(centroids[i].size()));
+				offset += static_cast<int>(centroids[i].size());
+			}
+
+			return output;
+		}
+
+		// Quality of a block of linear tetrahedra given as separate x, y and z coordinate
+		// arrays and four zero-based node indices per element. See QualityKernels.h for
+		// the definition of each measure; minDihedral is in degrees.
+		static void GetTetrahedronQuality(array<double>^ x, array<double>^ y, array<double>^ z, array<int>^ tetrahedra,
+			[System::Runtime::InteropServices::Out] array<double>^% volume,
+			[System::Runtime::InteropServices::Out] array<double>^% gamma,
+			[System::Runtime::InteropServices::Out] array<double>^% aspectRatio,
+			[System::Runtime::InteropServices::Out] array<double>^% minEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% maxEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% minDihedral)
+		{
+			GetQuality(4, x, y, z, tetrahedra, volume, gamma, aspectRatio, minEdge, maxEdge, minDihedral);
+		}
+
+		// As above, with interleaved xyz coordinates.
+		static void GetTetrahedronQuality(array<double>^ coords, array<int>^ tetrahedra,
+			[System::Runtime::InteropServices::Out] array<double>^% volume,
+			[System::Runtime::InteropServices::Out] array<double>^% gamma,
+			[System::Runtime::InteropServices::Out] array<double>^% aspectRatio,
+			[System::Runtime::InteropServices::Out] array<double>^% minEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% maxEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% minDihedral)
+		{
+			array<double>^ x, ^ y, ^ z;
+			Split(coords, x, y, z);
+			GetQuality(4, x, y, z, tetrahedra, volume, gamma, aspectRatio, minEdge, maxEdge, minDihedral);
+		}
+
+		// Quality of a block of linear triangles; minAngle is the smallest corner angle in degrees.
+		static void GetTriangleQuality(array<double>^ x, array<double>^ y, array<double>^ z, array<int>^ triangles,
+			[System::Runtime::InteropServices::Out] array<double>^% area,
+			[System::Runtime::InteropServices::Out] array<double>^% gamma,
+			[System::Runtime::InteropServices::Out] array<double>^% aspectRatio,
+			[System::Runtime::InteropServices::Out] array<double>^% minEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% maxEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% minAngle)
+		{
+			GetQuality(3, x, y, z, triangles, area, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+		}
+
+		static void GetTriangleQuality(array<double>^ coords, array<int>^ triangles,
+			[System::Runtime::InteropServices::Out] array<double>^% area,
+			[System::Runtime::InteropServices::Out] array<double>^% gamma,
+			[System::Runtime::InteropServices::Out] array<double>^% aspectRatio,
+			[System::Runtime::InteropServices::Out] array<double>^% minEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% maxEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% minAngle)
+		{
+			array<double>^ x, ^ y, ^ z;
+			Split(coords, x, y, z);
+			GetQuality(3, x, y, z, triangles, area, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+		}
+
+		// Quality of all 4-node tetrahedra (elementType 4) or 3-node triangles (elementType 2)
+		// on entity 'tag' of the current mesh, in the order returned by GetElementsByType.
+		static void GetElementQuality(int elementType, int tag,
+			[System::Runtime::InteropServices::Out] array<double>^% size,
+			[System::Runtime::InteropServices::Out] array<double>^% gamma,
+			[System::Runtime::InteropServices::Out] array<double>^% aspectRatio,
+			[System::Runtime::InteropServices::Out] array<double>^% minEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% maxEdge,
+			[System::Runtime::InteropServices::Out] array<double>^% minAngle)
+		{
+			if (elementType != 2 && elementType != 4)
+				throw gcnew System::ArgumentException("Only 3-node triangles (2) and 4-node tetrahedra (4) are supported.");
+
+			Native::MeshBlock block;
+			Native::GetMeshBlock(elementType, tag, block);
+
+			size_t numNodes = block.nodeTags.size();
+			std::vector<double> x(numNodes), y(numNodes), z(numNodes);
+			for (int i = 0; i < numNodes; ++i)
+			{
+				x[i] = block.coords[i * 3];
+				y[i] = block.coords[i * 3 + 1];
+				z[i] = block.coords[i * 3 + 2];
+			}
+
+			AllocateQuality(static_cast<int>(block.elementTags.size()), size, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+			RunQuality(elementType == 4 ? 4 : 3, x.data(), y.data(), z.data(), block.connectivity.data(), block.elementTags.size(), size, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+		}
+
+	private:
+		static void Split(array<double>^ coords, array<double>^% x, array<double>^% y, array<double>^% z)
+		{
+			if (coords == nullptr) throw gcnew System::ArgumentNullException("coords");
+
+			int n = coords->Length / 3;
+			x = gcnew array<double>(n);
+			y = gcnew array<double>(n);
+			z = gcnew array<double>(n);
+
+			for (int i = 0; i < n; ++i)
+			{
+				x[i] = coords[i * 3];
+				y[i] = coords[i * 3 + 1];
+				z[i] = coords[i * 3 + 2];
+			}
+		}
+
+		static void AllocateQuality(int n, array<double>^% size, array<double>^% gamma, array<double>^% aspectRatio, array<double>^% minEdge, array<double>^% maxEdge, array<double>^% minAngle)
+		{
+			size = gcnew array<double>(n);
+			gamma = gcnew array<double>(n);
+			aspectRatio = gcnew array<double>(n);
+			minEdge = gcnew array<double>(n);
+			maxEdge = gcnew array<double>(n);
+			minAngle = gcnew array<double>(n);
+		}
+
+		static void GetQuality(int nodesPerElement, array<double>^ x, array<double>^ y, array<double>^ z, array<int>^ connectivity,
+			array<double>^% size, array<double>^% gamma, array<double>^% aspectRatio, array<double>^% minEdge, array<double>^% maxEdge, array<double>^% minAngle)
+		{
+			if (x == nullptr || y == nullptr || z == nullptr || connectivity == nullptr)
+				throw gcnew System::ArgumentNullException();
+			if (y->Length != x->Length || z->Length != x->Length)
+				throw gcnew System::ArgumentException("Coordinate arrays must have the same length.");
+			if (connectivity->Length % nodesPerElement != 0)
+				throw gcnew System::ArgumentException("Connectivity length is not a multiple of the nodes per element.");
+
+			for (int i = 0; i < connectivity->Length; ++i)
+				if (connectivity[i] < 0 || connectivity[i] >= x->Length)
+					throw gcnew System::IndexOutOfRangeException("Node index out of range.");
+
+			int n = connectivity->Length / nodesPerElement;
+			AllocateQuality(n, size, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+			if (n < 1) return;
+
+			pin_ptr<double> px = &x[0], py = &y[0], pz = &z[0];
+			pin_ptr<int> pc = &connectivity[0];
+			RunQuality(nodesPerElement, px, py, pz, pc, n, size, gamma, aspectRatio, minEdge, maxEdge, minAngle);
+		}
+
+		static void RunQuality(int nodesPerElement, const double* x, const double* y, const double* z, const int* connectivity, size_t n,
+			array<double>^ size, array<double>^ gamma, array<double>^ aspectRatio, array<double>^ minEdge, array<double>^ maxEdge, array<double>^ minAngle)
+		{
+			if (n < 1) return;
+
+			pin_ptr<double> pSize = &size[0], pGamma = &gamma[0], pAspect = &aspectRatio[0];
+			pin_ptr<double> pMinEdge = &minEdge[0], pMaxEdge = &maxEdge[0], pMinAngle = &minAngle[0];
+
+			Native::QualityOutput output = { pSize, pGamma, pAspect, pMinEdge, pMaxEdge, pMinAngle };
+
+			if (nodesPerElement == 4)
+				Native::TetrahedronQuality(x, y, z, connectivity, n, output);
+			else
+				Native::TriangleQuality(x, y, z, connectivity, n, output);
+		}
 	};
 }
 
@@ -0,0 +1,431 @@
+#pragma once
+
+#include <cstring>
+#include <msclr\lock.h>
+
+#include "ElementBlocks.h"
+#include "WorkerProtocol.h"
+
+using System::IntPtr;
+using System::Runtime::InteropServices::Marshal;
+
+namespace GmshCommon {
+
+	/// <summary>
+	/// An independent meshing job: open InputFile, apply the options, generate a mesh
+	/// of the given dimension.
+	/// </summary>
+	public ref class MeshJob
+	{
+	public:
+		MeshJob(System::String^ inputFile, int dimension) : m_inputFile(inputFile), m_dimension(dimension)
+		{
+			m_numberOptions = gcnew System::Collections::Generic::Dictionary<System::String^, double>();
+			m_stringOptions = gcnew System::Collections::Generic::Dictionary<System::String^, System::String^>();
+		}
+
+		property System::String^ InputFile
+		{
+			System::String^ get() { return m_inputFile; }
+		}
+
+		property int Dimension
+		{
+			int get() { return m_dimension; }
+		}
+
+		property System::Collections::Generic::Dictionary<System::String^, double>^ NumberOptions
+		{
+			System::Collections::Generic::Dictionary<System::String^, double>^ get() { return m_numberOptions; }
+		}
+
+		property System::Collections::Generic::Dictionary<System::String^, System::String^>^ StringOptions
+		{
+			System::Collections::Generic::Dictionary<System::String^, System::String^>^ get() { return m_stringOptions; }
+		}
+
+	private:
+		System::String^ m_inputFile;
+		int m_dimension;
+		System::Collections::Generic::Dictionary<System::String^, double>^ m_numberOptions;
+		System::Collections::Generic::Dictionary<System::String^, System::String^>^ m_stringOptions;
+	};
+
+	/// <summary>
+	/// The mesh produced by a MeshJob, in the flat layout of GetNodes and
+	/// GetElementBlocks, or the error that stopped it.
+	/// </summary>
+	public ref class MeshJobResult
+	{
+	public:
+		property bool Succeeded
+		{
+			bool get() { return m_error == nullptr; }
+		}
+
+		property System::String^ Error
+		{
+			System::String^ get() { return m_error; }
+		}
+
+		property array<IntPtr>^ NodeTags
+		{
+			array<IntPtr>^ get() { return m_nodeTags; }
+		}
+
+		property array<double>^ Coords
+		{
+			array<double>^ get() { return m_coords; }
+		}
+
+		property ElementBlocks^ Elements
+		{
+			ElementBlocks^ get() { return m_elements; }
+		}
+
+	internal:
+		MeshJobResult(System::String^ error) : m_error(error) {}
+
+		MeshJobResult(array<IntPtr>^ nodeTags, array<double>^ coords, ElementBlocks^ elements)
+			: m_nodeTags(nodeTags), m_coords(coords), m_elements(elements) {}
+
+	private:
+		System::String^ m_error;
+		array<IntPtr>^ m_nodeTags;
+		array<double>^ m_coords;
+		ElementBlocks^ m_elements;
+	};
+
+	/// <summary>
+	/// Runs independent MeshJobs on a pool of GmshWorker processes, each with its own
+	/// gmsh instance, so throughput scales with cores despite gmsh's global state.
+	/// Results come back through shared memory (see WorkerProtocol.h).
+	/// </summary>
+	public ref class WorkerPool : System::IDisposable
+	{
+	public:
+		// Uses GmshWorker.exe next to this assembly.
+		WorkerPool(int numWorkers)
+		{
+			Initialize(DefaultWorkerPath, numWorkers);
+		}
+
+		WorkerPool(System::String^ workerPath, int numWorkers)
+		{
+			Initialize(workerPath, numWorkers);
+		}
+
+		~WorkerPool()
+		{
+			if (m_workers == nullptr) return;
+
+			for (int i = 0; i < m_workers->Length; ++i)
+				m_workers[i]->Stop();
+			m_workers = nullptr;
+		}
+
+		static property System::String^ DefaultWorkerPath
+		{
+			System::String^ get()
+			{
+				return System::IO::Path::Combine(System::IO::Path::GetDirectoryName(WorkerPool::typeid->Assembly->Location), "GmshWorker.exe");
+			}
+		}
+
+		property int NumWorkers
+		{
+			int get() { return m_workers == nullptr ? 0 : m_workers->Length; }
+		}
+
+		// How long a worker may take over one job before it is killed, and restarted
+		// for the next one. Defaults to 30 minutes; Timeout::InfiniteTimeSpan waits forever.
+		property System::TimeSpan JobTimeout
+		{
+			System::TimeSpan get() { return m_jobTimeout; }
+			void set(System::TimeSpan value)
+			{
+				if (value < System::TimeSpan::Zero && value != System::Threading::Timeout::InfiniteTimeSpan)
+					throw gcnew System::ArgumentOutOfRangeException("value");
+				m_jobTimeout = value;
+			}
+		}
+
+		// Runs all jobs and returns their results in the same order. Workers are started
+		// on first use and kept for later calls; a worker that dies is restarted.
+		array<MeshJobResult^>^ Run(array<MeshJob^>^ jobs)
+		{
+			if (jobs == nullptr) throw gcnew System::ArgumentNullException("jobs");
+			if (m_workers == nullptr) throw gcnew System::ObjectDisposedException("WorkerPool");
+
+			msclr::lock l(m_runLock);
+
+			m_jobs = jobs;
+			m_results = gcnew array<MeshJobResult^>(jobs->Length);
+			m_next = -1;
+
+			int numThreads = System::Math::Min(m_workers->Length, jobs->Length);
+			array<System::Threading::Thread^>^ threads = gcnew array<System::Threading::Thread^>(numThreads);
+			for (int i = 0; i < numThreads; ++i)
+			{
+				threads[i] = gcnew System::Threading::Thread(gcnew System::Threading::ParameterizedThreadStart(this, &WorkerPool::Drain));
+				threads[i]->IsBackground = true;
+				threads[i]->Start(i);
+			}
+
+			for (int i = 0; i < numThreads; ++i)
+				threads[i]->Join();
+
+			array<MeshJobResult^>^ results = m_results;
+			m_jobs = nullptr;
+			m_results = nullptr;
+
+			return results;
+		}
+
+	private:
+		ref class WorkerProcess
+		{
+		public:
+			WorkerProcess(System::String^ path) : m_path(path) {}
+
+			MeshJobResult^ Execute(MeshJob^ job, int id, System::TimeSpan timeout)
+			{
+				System::String^ invalid = Validate(job);
+				if (invalid != nullptr) return gcnew MeshJobResult(invalid);
+
+				try
+				{
+					if (m_process == nullptr || m_process->HasExited) Start();
+
+					System::IO::StreamWriter^ input = m_process->StandardInput;
+					System::Globalization::CultureInfo^ invariant = System::Globalization::CultureInfo::InvariantCulture;
+
+					input->WriteLine("JOB {0}", id);
+					if (job->InputFile != nullptr)
+						input->WriteLine("INPUT " + job->InputFile);
+					for each (System::Collections::Generic::KeyValuePair<System::String^, double> option in job->NumberOptions)
+						input->WriteLine("NUMBER " + option.Key + " " + option.Value.ToString("R", invariant));
+					for each (System::Collections::Generic::KeyValuePair<System::String^, System::String^> option in job->StringOptions)
+						input->WriteLine("STRING " + option.Key + " " + option.Value);
+					input->WriteLine("GENERATE {0}", job->Dimension);
+					input->WriteLine("END");
+					input->Flush();
+
+					System::Threading::Tasks::Task<System::String^>^ read = m_process->StandardOutput->ReadLineAsync();
+					if (!read->Wait(timeout))
+					{
+						// Hung in gmsh: the next job gets a new process
+						Kill();
+						return gcnew MeshJobResult("Worker timed out after " + timeout.ToString() + ".");
+					}
+
+					System::String^ reply = read->Result;
+					if (reply == nullptr)
+					{
+						Stop();
+						return gcnew MeshJobResult("Worker process exited.");
+					}
+
+					if (reply->StartsWith("ERROR ")) return gcnew MeshJobResult(reply->Substring(6));
+
+					array<System::String^>^ parts = reply->Split(' ');
+					if (parts->Length != 3 || parts[0] != "DONE") return gcnew MeshJobResult("Unexpected reply: " + reply);
+
+					try
+					{
+						return ReadResult(parts[1], System::Int64::Parse(parts[2], invariant));
+					}
+					finally
+					{
+						input->WriteLine("ACK");
+						input->Flush();
+					}
+				}
+				catch (System::Exception^ e)
+				{
+					Stop();
+					return gcnew MeshJobResult(e->Message);
+				}
+			}
+
+			void Stop()
+			{
+				if (m_process == nullptr) return;
+
+				try
+				{
+					if (!m_process->HasExited)
+					{
+						m_process->StandardInput->WriteLine("QUIT");
+						m_process->StandardInput->Flush();
+						if (!m_process->WaitForExit(2000)) m_process->Kill();
+					}
+				}
+				catch (System::Exception^)
+				{
+				}
+
+				delete m_process;
+				m_process = nullptr;
+			}
+
+		private:
+			void Kill()
+			{
+				try
+				{
+					if (!m_process->HasExited) m_process->Kill();
+					m_process->WaitForExit();
+				}
+				catch (System::Exception^)
+				{
+				}
+
+				delete m_process;
+				m_process = nullptr;
+			}
+
+			// The request is line based and splits option lines at the first space, so
+			// names must not contain whitespace and values no line breaks.
+			static System::String^ Validate(MeshJob^ job)
+			{
+				array<wchar_t>^ lineBreaks = gcnew array<wchar_t> { '\r', '\n' };
+
+				if (job->InputFile != nullptr && job->InputFile->IndexOfAny(lineBreaks) >= 0)
+					return "The input file name contains a line break.";
+
+				for each (System::String^ name in job->NumberOptions->Keys)
+					if (!IsOptionName(name)) return "Invalid option name: " + name;
+
+				for each (System::Collections::Generic::KeyValuePair<System::String^, System::String^> option in job->StringOptions)
+				{
+					if (!IsOptionName(option.Key)) return "Invalid option name: " + option.Key;
+					if (option.Value != nullptr && option.Value->IndexOfAny(lineBreaks) >= 0)
+						return "The value of " + option.Key + " contains a line break.";
+				}
+
+				return nullptr;
+			}
+
+			static bool IsOptionName(System::String^ name)
+			{
+				if (System::String::IsNullOrEmpty(name)) return false;
+
+				for each (wchar_t c in name)
+					if (System::Char::IsWhiteSpace(c)) return false;
+
+				return true;
+			}
+
+			void Start()
+			{
+				Stop();
+
+				System::Diagnostics::ProcessStartInfo^ info = gcnew System::Diagnostics::ProcessStartInfo(m_path);
+				info->UseShellExecute = false;
+				info->CreateNoWindow = true;
+				info->RedirectStandardInput = true;
+				info->RedirectStandardOutput = true;
+				info->WorkingDirectory = System::IO::Path::GetDirectoryName(m_path);
+
+				m_process = System::Diagnostics::Process::Start(info);
+			}
+
+			static MeshJobResult^ ReadResult(System::String^ name, long long bytes)
+			{
+				using namespace System::IO::MemoryMappedFiles;
+
+				MemoryMappedFile^ file = MemoryMappedFile::OpenExisting(name, MemoryMappedFileRights::Read);
+				MemoryMappedViewAccessor^ view = file->CreateViewAccessor(0, bytes, MemoryMappedFileAccess::Read);
+
+				unsigned char* base = nullptr;
+				view->SafeMemoryMappedViewHandle->AcquirePointer(base);
+
+				try
+				{
+					const unsigned char* data = base + view->PointerOffset;
+
+					Worker::ResultHeader header;
+					std::memcpy(&header, data, sizeof(header));
+
+					if (header.magic != Worker::ResultMagic || header.version != Worker::ResultVersion)
+						return gcnew MeshJobResult("Worker result has an unknown format.");
+
+					Worker::ResultLayout layout = Worker::GetLayout(header);
+					if (layout.total > static_cast<uint64_t>(bytes))
+						return gcnew MeshJobResult("Worker result is truncated.");
+
+					int numNodes = static_cast<int>(header.numNodes), numBlocks = static_cast<int>(header.numBlocks);
+					int numElements = static_cast<int>(header.numElements), numElementNodes = static_cast<int>(header.numElementNodes);
+
+					array<IntPtr>^ nodeTags = gcnew array<IntPtr>(numNodes);
+					array<double>^ coords = gcnew array<double>(numNodes * 3);
+					array<int>^ types = gcnew array<int>(numBlocks);
+					array<int>^ counts = gcnew array<int>(numBlocks);
+					array<int>^ nodesPerElement = gcnew array<int>(numBlocks);
+					array<IntPtr>^ elementTags = gcnew array<IntPtr>(numElements);
+					array<IntPtr>^ elementNodeTags = gcnew array<IntPtr>(numElementNodes);
+
+					if (numNodes > 0)
+					{
+						Marshal::Copy(IntPtr((void*)(data + layout.nodeTags)), nodeTags, 0, numNodes);
+						Marshal::Copy(IntPtr((void*)(data + layout.coords)), coords, 0, numNodes * 3);
+					}
+
+					if (numBlocks > 0)
+					{
+						Marshal::Copy(IntPtr((void*)(data + layout.elementTypes)), types, 0, numBlocks);
+						Marshal::Copy(IntPtr((void*)(data + layout.elementCounts)), counts, 0, numBlocks);
+						Marshal::Copy(IntPtr((void*)(data + layout.nodesPerElement)), nodesPerElement, 0, numBlocks);
+					}
+
+					if (numElements > 0)
+						Marshal::Copy(IntPtr((void*)(data + layout.elementTags)), elementTags, 0, numElements);
+					if (numElementNodes > 0)
+						Marshal::Copy(IntPtr((void*)(data + layout.elementNodeTags)), elementNodeTags, 0, numElementNodes);
+
+					return gcnew MeshJobResult(nodeTags, coords, gcnew ElementBlocks(types, counts, nodesPerElement, elementTags, elementNodeTags));
+				}
+				finally
+				{
+					view->SafeMemoryMappedViewHandle->ReleasePointer();
+					delete view;
+					delete file;
+				}
+			}
+
+			System::String^ m_path;
+			System::Diagnostics::Process^ m_process;
+		};
+
+		void Initialize(System::String^ workerPath, int numWorkers)
+		{
+			if (workerPath == nullptr) throw gcnew System::ArgumentNullException("workerPath");
+			if (!System::IO::File::Exists(workerPath)) throw gcnew System::IO::FileNotFoundException("Worker executable not found.", workerPath);
+			if (numWorkers < 1) numWorkers = System::Environment::ProcessorCount;
+
+			m_workers = gcnew array<WorkerProcess^>(numWorkers);
+			for (int i = 0; i < numWorkers; ++i)
+				m_workers[i] = gcnew WorkerProcess(workerPath);
+
+			m_runLock = gcnew System::Object();
+			m_jobTimeout = System::TimeSpan::FromMinutes(30);
+		}
+
+		void Drain(System::Object^ index)
+		{
+			WorkerProcess^ worker = m_workers[safe_cast<int>(index)];
+
+			int i;
+			while ((i = System::Threading::Interlocked::Increment(m_next)) < m_jobs->Length)
+				m_results[i] = worker->Execute(m_jobs[i], i, m_jobTimeout);
+		}
+
+		array<WorkerProcess^>^ m_workers;
+		System::Object^ m_runLock;
+		System::TimeSpan m_jobTimeout;
+		array<MeshJob^>^ m_jobs;
+		array<MeshJobResult^>^ m_results;
+		int m_next;
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+// Shared between GmshWorker.exe and WorkerPool.
+//
+// Requests go to the worker's standard input as lines:
+//   JOB <id>
+//   INPUT <file to open>
+//   NUMBER <option> <value>		(any number of times)
+//   STRING <option> <value>		(any number of times)
+//   GENERATE <dim>
+//   END
+// and QUIT to stop it. Option names contain no whitespace and values and the
+// input file name no line breaks; WorkerPool rejects jobs that would break this.
+// Each job starts from gmsh's default options, and its options are applied after
+// the input is opened. The worker answers on standard output with one line,
+// either "DONE <shared memory name> <bytes>" or "ERROR <message>". After DONE it
+// keeps the shared memory open until it reads "ACK".
+
+namespace GmshCommon {
+
+	namespace Worker {
+
+		const uint32_t ResultMagic = 0x52574D47;	// "GMWR"
+		const uint32_t ResultVersion = 1;
+
+		// Start of the shared memory block. The sections follow in this order, each
+		// starting on an 8-byte boundary:
+		//   uint64 nodeTags[numNodes], double coords[3 * numNodes],
+		//   int32 elementTypes[numBlocks], int32 elementCounts[numBlocks], int32 nodesPerElement[numBlocks],
+		//   uint64 elementTags[numElements], uint64 elementNodeTags[numElementNodes]
+		struct ResultHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t numNodes;
+			uint64_t numBlocks;
+			uint64_t numElements;
+			uint64_t numElementNodes;
+		};
+
+		// Byte offsets of the sections
+		struct ResultLayout
+		{
+			uint64_t nodeTags, coords;
+			uint64_t elementTypes, elementCounts, nodesPerElement;
+			uint64_t elementTags, elementNodeTags;
+			uint64_t total;
+		};
+
+		inline uint64_t Align8(uint64_t bytes)
+		{
+			return (bytes + 7) & ~static_cast<uint64_t>(7);
+		}
+
+		inline ResultLayout GetLayout(const ResultHeader& header)
+		{
+			ResultLayout layout;
+			layout.nodeTags = Align8(sizeof(ResultHeader));
+			layout.coords = layout.nodeTags + header.numNodes * 8;
+			layout.elementTypes = layout.coords + header.numNodes * 3 * 8;
+			layout.elementCounts = layout.elementTypes + Align8(header.numBlocks * 4);
+			layout.nodesPerElement = layout.elementCounts + Align8(header.numBlocks * 4);
+			layout.elementTags = layout.nodesPerElement + Align8(header.numBlocks * 4);
+			layout.elementNodeTags = layout.elementTags + header.numElements * 8;
+			layout.total = layout.elementNodeTags + header.numElementNodes * 8;
+			return layout;
+		}
+	}
+}
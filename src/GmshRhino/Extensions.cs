@@ -96,90 +96,32 @@ namespace GmshCommon
 
         public static Mesh GetMesh(Pair[] dimTags)
         {
-
-            List<Pair> dimTagList = new List<Pair>();
-
-            foreach (var dimTag in dimTags)
-            {
-                if (dimTag.Item1 == 3)
-                {
-                    Pair[] boundaries;
-                    Gmsh.Model.GetBoundary(new Tuple<int, int>[] { dimTag }, out boundaries, true, false, false);
-                    dimTagList.AddRange(boundaries);
-                }
-                else
-                    dimTagList.Add(dimTag);
-            }
-
-            if (dimTagList.Count < 1)
+            if (dimTags == null || dimTags.Length < 1)
             {
                 throw new Exception("No valid entities present.");
             }
 
-            var nodes = new Dictionary<int, Point3d>();
-            var indexMap = new Dictionary<int, int>();
-
-            int totalNodes = 0;
-            foreach (var dimTag in dimTagList)
-            {
-                IntPtr[] nodeTags;
-                double[] coords;
-                Gmsh.Model.Mesh.GetNodes(out nodeTags, out coords, 2, dimTag.Item2, true, false);
-
-                if (nodeTags == null || nodeTags.Length < 1) continue;
-
-                for (int i = 0; i < nodeTags.Length; ++i)
-                {
-                    indexMap[(int)nodeTags[i]] = totalNodes + i;
-                    nodes[totalNodes + i] = new Point3d(
-                      coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2]);
-                }
-
-                totalNodes += nodeTags.Length;
-            }
+            double[] vertices;
+            int[] triangles, quads;
 
-            if (totalNodes < 1) throw new Exception("Couldn't get any nodes!");
+            Gmsh.Model.Mesh.ExtractSurfaceMesh(dimTags.Select(x => new DimTag(x.Item1, x.Item2)).ToArray(),
+                out vertices, out triangles, out quads);
 
             var mesh = new Mesh();
-            mesh.Vertices.AddVertices(nodes.Values);
 
-            foreach (var dimTag in dimTagList)
+            for (int i = 0; i < vertices.Length; i += 3)
             {
-                int[] elementTypes;
-                IntPtr[][] elementTags, enodeTags;
-
-                Gmsh.Model.Mesh.GetElements(out elementTypes, out elementTags, out enodeTags, 2, dimTag.Item2);
-
-                for (int i = 0; i < elementTypes.Length; ++i)
-                {
-                    if (elementTypes[i] == 2)
-                    {
+                mesh.Vertices.Add(vertices[i], vertices[i + 1], vertices[i + 2]);
+            }
 
-                        for (int j = 0; j < enodeTags[i].Length; j += 3)
-                        {
-                            mesh.Faces.AddFace(
-                              indexMap[(int)enodeTags[i][j]],
-                              indexMap[(int)enodeTags[i][j + 1]],
-                              indexMap[(int)enodeTags[i][j + 2]]);
-                        }
-                    }
-                    else if (elementTypes[i] == 3)
-                    {
+            for (int i = 0; i < triangles.Length; i += 3)
+            {
+                mesh.Faces.AddFace(triangles[i], triangles[i + 1], triangles[i + 2]);
+            }
 
-                        for (int j = 0; j < enodeTags[i].Length; j += 4)
-                        {
-                            mesh.Faces.AddFace(
-                              indexMap[(int)enodeTags[i][j]],
-                              indexMap[(int)enodeTags[i][j + 1]],
-                              indexMap[(int)enodeTags[i][j + 2]],
-                              indexMap[(int)enodeTags[i][j + 3]]);
-                        }
-                    }
-                    else
-                    {
-                        continue;
-                    }
-                }
+            for (int i = 0; i < quads.Length; i += 4)
+            {
+                mesh.Faces.AddFace(quads[i], quads[i + 1], quads[i + 2], quads[i + 3]);
             }
 
             mesh.Compact();
@@ -322,7 +264,6 @@ namespace GmshCommon
                     var pTag = Gmsh.Model.OCC.AddPoint(cptLoc.X, cptLoc.Y, cptLoc.Z);
                     pointTags.Add(pTag);
 
-                    Gmsh.Model.OCC.Synchronize();
                     weights.Add(cpt.Weight);
                     pts.Add(cpt.Location);
                 }
@@ -354,128 +295,200 @@ namespace GmshCommon
               weights.ToArray(), knotsU, knotsV, multsU, multsV);
         }
 
-        public static int AddBrep(Brep brep, bool heal = true)
+        public static int AddBrep(Brep brep, bool heal = true, bool shareEdges = true)
         {
             List<int> faces = new List<int>();
-            return AddBrep(brep, faces, heal);
+            return AddBrep(brep, faces, heal, shareEdges);
         }
 
 
-        public static int AddBrep(Brep brep, List<int> faces, bool heal = true)
+        public static int AddBrep(Brep brep, List<int> faces, bool heal = true, bool shareEdges = true)
         {
-            var verts = new List<int>();
-            var edges = new List<int>();
-            var curves3d = new List<int>();
-            var loops = new List<int>();
-            var trims = new List<int>();
-            var surfaces = new List<int>();
-            //var faces = new List<int>();
+            int[] faceTags;
+            int volume = Gmsh.Model.OCC.AddBrep(ToBrepDescription(brep, shareEdges), brep.IsSolid, heal, out faceTags);
 
-            foreach (BrepVertex vertex in brep.Vertices)
-            {
-                //Gmsh.OCC.AddPoint(vertex.Location.X, vertex.Location.Y, vertex.Location.Z, -1);
-            }
+            faces.AddRange(faceTags);
 
-            foreach (var edge in brep.Edges)
-            {
-                var crv = edge.EdgeCurve;
-                var bspline = crv.ToNurbsCurve();
-                curves3d.Add(AddBSpline(bspline));
-            }
+            return volume;
+        }
 
-            foreach (BrepTrim trim in brep.Trims)
-            {
-                var crv = trim.TrimCurve;
-                var bspline = crv.ToNurbsCurve();
-                trims.Add(AddBSpline(bspline));
-            }
+        /// <summary>
+        /// Flattens a Brep for Gmsh.Model.OCC.AddBrep, with one B-spline surface per Brep
+        /// surface. If shareEdges, each edge becomes one 3D curve between shared vertices,
+        /// used by the loops of all faces it bounds, so the faces arrive sewn. Otherwise
+        /// each trim becomes its own curve in the parameter space of its face.
+        /// </summary>
+        public static BrepDescription ToBrepDescription(Brep brep, bool shareEdges = true)
+        {
+            var curveDegrees = new List<int>();
+            var curvePointOffsets = new List<int> { 0 };
+            var curvePoints = new List<double>();
+            var curveWeights = new List<double>();
+            var curveKnotOffsets = new List<int> { 0 };
+            var curveKnots = new List<double>();
+            var curveMults = new List<int>();
 
-            foreach (Surface srf in brep.Surfaces)
-            {
-                surfaces.Add(AddBSplineSurface(srf));
-                Gmsh.Model.OCC.Synchronize();
-            }
+            double[] knots;
+            int[] mults;
 
-            foreach (BrepFace face in brep.Faces)
-            {
-                var wires = new List<int>();
+            var curves = shareEdges
+                ? brep.Edges.Select(x => x.ToNurbsCurve())
+                : brep.Trims.Select(x => x.ToNurbsCurve());
 
-                foreach (BrepLoop loop in face.Loops)
+            foreach (NurbsCurve bspline in curves)
+            {
+                int end = bspline.Points.Count;
+                if (bspline.IsPeriodic)
                 {
-                    var wire = new List<int>();
-                    var test = new List<int>();
+                    end = bspline.Points.Count - bspline.Degree;
+                }
 
-                    foreach (BrepTrim trim in loop.Trims)
-                    {
+                for (int i = 0; i < end; ++i)
+                {
+                    var cpt = bspline.Points[i];
 
-                        //wire.Add(trims[trim.TrimIndex]);
-                        //wire.Add(curves3d[trim.Edge.EdgeCurveIndex]);
-                        //test.Add(trim.Edge.EdgeCurveIndex);
+                    curvePoints.Add(cpt.Location.X);
+                    curvePoints.Add(cpt.Location.Y);
+                    curvePoints.Add(cpt.Location.Z);
+                    curveWeights.Add(cpt.Weight);
+                }
 
-                        if (brep.Surfaces[face.SurfaceIndex] is PlaneSurface && false)
-                        {
-                            wire.Add(AddBSpline(trim.Edge.ToNurbsCurve()));
-                        }
-                        else
-                        {
-                            wire.Add(AddBSpline(trim.ToNurbsCurve()));
-                        }
-                    }
+                KnotsToOCC(bspline.Knots, bspline.Degree, out knots, out mults);
 
-                    var wireTag = Gmsh.Model.OCC.AddWire(wire.ToArray(), -1, true);
+                curveDegrees.Add(bspline.Degree);
+                curvePointOffsets.Add(curveWeights.Count);
+                curveKnots.AddRange(knots);
+                curveMults.AddRange(mults);
+                curveKnotOffsets.Add(curveKnots.Count);
+            }
 
-                    wires.Add(wireTag);
-                }
+            var vertexPoints = new List<double>();
+            var curveVertices = new List<int>();
 
-                if (brep.Surfaces[face.SurfaceIndex] is NurbsSurface || true)
+            if (shareEdges)
+            {
+                foreach (BrepVertex vertex in brep.Vertices)
                 {
-                    faces.Add(Gmsh.Model.OCC.AddTrimmedSurface(surfaces[face.SurfaceIndex], wires.ToArray(), false));
-                    //faces.Add(surfaces[face.SurfaceIndex]);
+                    vertexPoints.Add(vertex.Location.X);
+                    vertexPoints.Add(vertex.Location.Y);
+                    vertexPoints.Add(vertex.Location.Z);
                 }
-                else if (brep.Surfaces[face.SurfaceIndex] is PlaneSurface)
+
+                foreach (BrepEdge edge in brep.Edges)
                 {
-                    faces.Add(Gmsh.Model.OCC.AddPlaneSurface(wires.ToArray()));
+                    curveVertices.Add(edge.StartVertex != null ? edge.StartVertex.VertexIndex : -1);
+                    curveVertices.Add(edge.EndVertex != null ? edge.EndVertex.VertexIndex : -1);
                 }
-
-                Gmsh.Model.OCC.Synchronize();
             }
 
-            Gmsh.Model.OCC.Remove(surfaces.Select(x => new Pair(2, x)).ToArray(), true);
-            Gmsh.Model.OCC.Synchronize();
+            var surfaceDegrees = new List<int>();
+            var surfacePointsU = new List<int>();
+            var surfacePointOffsets = new List<int> { 0 };
+            var surfacePoints = new List<double>();
+            var surfaceWeights = new List<double>();
+            var surfaceKnotOffsets = new List<int> { 0 };
+            var surfaceKnots = new List<double>();
+            var surfaceMults = new List<int>();
 
-            Gmsh.Model.OCC.Remove(curves3d.Select(x => new Pair(1, x)).ToArray(), true);
-            Gmsh.Model.OCC.Synchronize();
+            foreach (Surface srf in brep.Surfaces)
+            {
+                var bsrf = srf.ToNurbsSurface();
 
-            Gmsh.Model.OCC.Remove(verts.Select(x => new Pair(0, x)).ToArray(), true);
-            Gmsh.Model.OCC.Synchronize();
+                for (int v = 0; v < bsrf.Points.CountV; ++v)
+                {
+                    for (int u = 0; u < bsrf.Points.CountU; ++u)
+                    {
+                        ControlPoint cpt = bsrf.Points.GetControlPoint(u, v);
 
-            var faceLoop = Gmsh.Model.OCC.AddSurfaceLoop(faces.ToArray());
+                        surfacePoints.Add(cpt.Location.X);
+                        surfacePoints.Add(cpt.Location.Y);
+                        surfacePoints.Add(cpt.Location.Z);
+                        surfaceWeights.Add(cpt.Weight);
+                    }
+                }
 
-            int volume = -1;
+                surfaceDegrees.Add(bsrf.Degree(0));
+                surfaceDegrees.Add(bsrf.Degree(1));
+                surfacePointsU.Add(bsrf.Points.CountU);
+                surfacePointOffsets.Add(surfaceWeights.Count);
 
-            if (brep.IsSolid)
-            {
-                volume = Gmsh.Model.OCC.AddVolume(new int[] { faceLoop });
-                Gmsh.Model.OCC.Synchronize();
+                KnotsToOCC(bsrf.KnotsU, bsrf.Degree(0), out knots, out mults);
+                surfaceKnots.AddRange(knots);
+                surfaceMults.AddRange(mults);
+                surfaceKnotOffsets.Add(surfaceKnots.Count);
 
+                KnotsToOCC(bsrf.KnotsV, bsrf.Degree(1), out knots, out mults);
+                surfaceKnots.AddRange(knots);
+                surfaceMults.AddRange(mults);
+                surfaceKnotOffsets.Add(surfaceKnots.Count);
             }
-            //RhinoApp.WriteLine("Volume tag: {0}", volume);
 
-            if (heal)
-            {
-                Pair[] outDimTags;
-                Pair[] dimTags = new Pair[] { new Pair(3, volume) };
+            var loopOffsets = new List<int> { 0 };
+            var loopCurves = new List<int>();
 
-                // HealShapes returns alllll the shapes in the model, even if dimTags is populated...
-                Gmsh.Model.OCC.HealShapes(out outDimTags, dimTags, 1e-06, true, true, true, true, true);
+            foreach (BrepLoop loop in brep.Loops)
+            {
+                foreach (BrepTrim trim in loop.Trims)
+                {
+                    if (!shareEdges)
+                    {
+                        loopCurves.Add(trim.TrimIndex);
+                    }
+                    else if (trim.Edge != null)
+                    {
+                        // Singular trims (at poles) have no edge to share
+                        loopCurves.Add(trim.Edge.EdgeIndex);
+                    }
+                }
 
-                // So assigning the result is meaningless. We assume that the tag doesn't change.
-                //volume = outDimTags[0].Item2;
+                loopOffsets.Add(loopCurves.Count);
             }
 
-            Gmsh.Model.OCC.Synchronize();
+            var faceSurfaces = new List<int>();
+            var faceLoopOffsets = new List<int> { 0 };
+            var faceLoops = new List<int>();
 
-            return volume;
+            foreach (BrepFace face in brep.Faces)
+            {
+                faceSurfaces.Add(face.SurfaceIndex);
+
+                foreach (BrepLoop loop in face.Loops)
+                {
+                    faceLoops.Add(loop.LoopIndex);
+                }
+
+                faceLoopOffsets.Add(faceLoops.Count);
+            }
+
+            return new BrepDescription
+            {
+                CurveDegrees = curveDegrees.ToArray(),
+                CurvePointOffsets = curvePointOffsets.ToArray(),
+                CurvePoints = curvePoints.ToArray(),
+                CurveWeights = curveWeights.ToArray(),
+                CurveKnotOffsets = curveKnotOffsets.ToArray(),
+                CurveKnots = curveKnots.ToArray(),
+                CurveMultiplicities = curveMults.ToArray(),
+                VertexPoints = vertexPoints.ToArray(),
+                CurveVertices = curveVertices.ToArray(),
+
+                SurfaceDegrees = surfaceDegrees.ToArray(),
+                SurfacePointsU = surfacePointsU.ToArray(),
+                SurfacePointOffsets = surfacePointOffsets.ToArray(),
+                SurfacePoints = surfacePoints.ToArray(),
+                SurfaceWeights = surfaceWeights.ToArray(),
+                SurfaceKnotOffsets = surfaceKnotOffsets.ToArray(),
+                SurfaceKnots = surfaceKnots.ToArray(),
+                SurfaceMultiplicities = surfaceMults.ToArray(),
+
+                LoopOffsets = loopOffsets.ToArray(),
+                LoopCurves = loopCurves.ToArray(),
+                FaceSurfaces = faceSurfaces.ToArray(),
+                FaceLoopOffsets = faceLoopOffsets.ToArray(),
+                FaceLoops = faceLoops.ToArray(),
+
+                Wire3D = shareEdges
+            };
         }
 
         /// <summary>
@@ -645,17 +658,12 @@ namespace GmshCommon
             var centroids = new List<Point3d>();
             try
             {
-                int[] elementTypes;
-                IntPtr[][] elementTags, enodeTags;
-                Gmsh.Model.Mesh.GetElements(out elementTypes, out elementTags, out enodeTags, 3, -1);
+                var coords = GmshCommon.Utility.GetCentroids(3, -1);
 
-                for (int i = 0; i < elementTypes.Length; ++i)
+                centroids.Capacity = coords.Length / 3;
+                for (int i = 0; i < coords.Length; i += 3)
                 {
-                    for (int j = 0; j < elementTags[i].Length; ++j)
-                    {
-                        var centroid = GmshCommon.Utility.GetCentroid(elementTags[i][j], elementTypes[i]);
-                        centroids.Add(new Point3d(centroid[0], centroid[1], centroid[2]));
-                    }
+                    centroids.Add(new Point3d(coords[i], coords[i + 1], coords[i + 2]));
                 }
             }
             catch (Exception e)
@@ -694,9 +702,27 @@ namespace GmshCommon
             var tools = new Pair[dimTags.Length - 1];
             Array.Copy(dimTags, 1, tools, 0, tools.Length);
 
-            Gmsh.Model.OCC.Fragment(obj, tools, out dimTagsOut, out dimTagsMap, true, true);
+            // Only entities with overlapping bounding boxes are fragmented together
+            DimTag[] flatOut, flatMap;
+            int[] mapOffsets;
+            Gmsh.Model.OCC.FragmentClustered(
+                obj.Select(x => new DimTag(x.Item1, x.Item2)).ToArray(),
+                tools.Select(x => new DimTag(x.Item1, x.Item2)).ToArray(),
+                out flatOut, out flatMap, out mapOffsets, true, true);
             Gmsh.Model.OCC.Synchronize();
 
+            dimTagsOut = flatOut.Select(x => new Pair(x.Dim, x.Tag)).ToArray();
+            dimTagsMap = new Pair[mapOffsets.Length - 1][];
+            for (int i = 0; i < dimTagsMap.Length; ++i)
+            {
+                dimTagsMap[i] = new Pair[mapOffsets[i + 1] - mapOffsets[i]];
+                for (int j = 0; j < dimTagsMap[i].Length; ++j)
+                {
+                    var dimTag = flatMap[mapOffsets[i] + j];
+                    dimTagsMap[i][j] = new Pair(dimTag.Dim, dimTag.Tag);
+                }
+            }
+
 
             var all = new Tuple<int, int>[obj.Length + tools.Length];
             Array.Copy(obj, 0, all, 0, obj.Length);
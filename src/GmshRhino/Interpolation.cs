@@ -62,10 +62,27 @@ namespace GmshRhino
             return new double[] { v0 * v1 };
         }
 
+        /// <summary>
+        /// Trilinear weights of the 8 corners of a hexahedron (Gmsh node ordering) at pt.
+        /// </summary>
         public double[] BoxTrilinear(Point3d pt, Point3d[] points)
         {
-
-            throw new NotImplementedException();
+            var coords = new double[24];
+            for (int i = 0; i < 8; ++i)
+            {
+                coords[i * 3] = points[i].X;
+                coords[i * 3 + 1] = points[i].Y;
+                coords[i * 3 + 2] = points[i].Z;
+            }
+
+            // Generous tolerance so that nearby points extrapolate, like the other helpers
+            using (var locator = new GmshCommon.PointLocator(coords, new int[] { 0, 1, 2, 3, 4, 5, 6, 7 }, 8, 8.0))
+            {
+                if (locator.Locate(pt.X, pt.Y, pt.Z, out double u, out double v, out double w) < 0)
+                    throw new ArgumentException("Point is too far outside the box.");
+
+                return GmshCommon.PointLocator.GetWeights(8, u, v, w);
+            }
         }
     }
 }
@@ -0,0 +1,227 @@
+// GmshWorker: runs meshing jobs for GmshCommon.WorkerPool in its own process, so
+// that each worker has a private gmsh instance. See WorkerProtocol.h.
+
+#define NOMINMAX
+#include <windows.h>
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmsh.h"
+#include "WorkerProtocol.h"
+
+using namespace GmshCommon::Worker;
+
+namespace {
+
+	struct Job
+	{
+		std::string id;
+		std::string input;
+		std::vector<std::pair<std::string, double>> numbers;
+		std::vector<std::pair<std::string, std::string>> strings;
+		int dim = 3;
+	};
+
+	// Splits "KEY rest of line" into its two parts.
+	std::pair<std::string, std::string> SplitFirst(const std::string& line)
+	{
+		size_t space = line.find(' ');
+		if (space == std::string::npos) return { line, std::string() };
+		return { line.substr(0, space), line.substr(space + 1) };
+	}
+
+	bool ReadJob(const std::string& first, Job& job)
+	{
+		job.id = SplitFirst(first).second;
+
+		std::string line;
+		while (std::getline(std::cin, line))
+		{
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line == "END") return true;
+
+			std::pair<std::string, std::string> entry = SplitFirst(line);
+			if (entry.first == "INPUT")
+				job.input = entry.second;
+			else if (entry.first == "GENERATE")
+				job.dim = std::stoi(entry.second);
+			else if (entry.first == "NUMBER" || entry.first == "STRING")
+			{
+				std::pair<std::string, std::string> option = SplitFirst(entry.second);
+				if (entry.first == "NUMBER")
+					job.numbers.push_back({ option.first, std::stod(option.second) });
+				else
+					job.strings.push_back(option);
+			}
+			else
+				throw std::runtime_error("Unknown request line: " + line);
+		}
+
+		return false;
+	}
+
+	// Shared memory that holds one result until the client acknowledges it.
+	class SharedResult
+	{
+	public:
+		SharedResult(const std::string& name, uint64_t bytes) : m_mapping(nullptr), m_view(nullptr)
+		{
+			m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+				static_cast<DWORD>(bytes >> 32), static_cast<DWORD>(bytes & 0xffffffff), name.c_str());
+			if (m_mapping == nullptr) throw std::runtime_error("CreateFileMapping failed.");
+
+			m_view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(bytes));
+			if (m_view == nullptr)
+			{
+				CloseHandle(m_mapping);
+				throw std::runtime_error("MapViewOfFile failed.");
+			}
+		}
+
+		~SharedResult()
+		{
+			UnmapViewOfFile(m_view);
+			CloseHandle(m_mapping);
+		}
+
+		char* Data() { return static_cast<char*>(m_view); }
+
+	private:
+		HANDLE m_mapping;
+		void* m_view;
+	};
+
+	void Write(char* base, uint64_t offset, const void* data, size_t bytes)
+	{
+		if (bytes > 0) std::memcpy(base + offset, data, bytes);
+	}
+
+	void RunJob(const Job& job, int sequence)
+	{
+		// Workers are reused, so start every job from the default options
+		gmsh::clear();
+		gmsh::option::restoreDefaults();
+		gmsh::option::setNumber("General.Terminal", 0);
+
+		if (!job.input.empty())
+			gmsh::open(job.input);
+
+		// After open, so that options set by a .geo input do not override the job's
+		for (const auto& option : job.numbers)
+			gmsh::option::setNumber(option.first, option.second);
+		for (const auto& option : job.strings)
+			gmsh::option::setString(option.first, option.second);
+
+		gmsh::model::mesh::generate(job.dim);
+
+		std::vector<size_t> nodeTags;
+		std::vector<double> coords, parametricCoords;
+		gmsh::model::mesh::getNodes(nodeTags, coords, parametricCoords, -1, -1, false, false);
+
+		std::vector<int> elementTypes;
+		std::vector<std::vector<size_t>> elementTags, elementNodeTags;
+		gmsh::model::mesh::getElements(elementTypes, elementTags, elementNodeTags, -1, -1);
+
+		ResultHeader header = { ResultMagic, ResultVersion, nodeTags.size(), elementTypes.size(), 0, 0 };
+		std::vector<int> counts(elementTypes.size()), nodesPerElement(elementTypes.size());
+		for (size_t i = 0; i < elementTypes.size(); ++i)
+		{
+			counts[i] = static_cast<int>(elementTags[i].size());
+			nodesPerElement[i] = counts[i] > 0 ? static_cast<int>(elementNodeTags[i].size() / counts[i]) : 0;
+			header.numElements += elementTags[i].size();
+			header.numElementNodes += elementNodeTags[i].size();
+		}
+
+		ResultLayout layout = GetLayout(header);
+		std::string name = "Local\\GmshWorker_" + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(sequence);
+
+		SharedResult result(name, layout.total);
+		char* base = result.Data();
+
+		Write(base, 0, &header, sizeof(header));
+		Write(base, layout.nodeTags, nodeTags.data(), nodeTags.size() * sizeof(size_t));
+		Write(base, layout.coords, coords.data(), coords.size() * sizeof(double));
+		Write(base, layout.elementTypes, elementTypes.data(), elementTypes.size() * sizeof(int));
+		Write(base, layout.elementCounts, counts.data(), counts.size() * sizeof(int));
+		Write(base, layout.nodesPerElement, nodesPerElement.data(), nodesPerElement.size() * sizeof(int));
+
+		uint64_t tagOffset = layout.elementTags, nodeOffset = layout.elementNodeTags;
+		for (size_t i = 0; i < elementTypes.size(); ++i)
+		{
+			Write(base, tagOffset, elementTags[i].data(), elementTags[i].size() * sizeof(size_t));
+			Write(base, nodeOffset, elementNodeTags[i].data(), elementNodeTags[i].size() * sizeof(size_t));
+			tagOffset += elementTags[i].size() * sizeof(size_t);
+			nodeOffset += elementNodeTags[i].size() * sizeof(size_t);
+		}
+
+		std::cout << "DONE " << name << " " << layout.total << std::endl;
+
+		// The client copies the result out before acknowledging it
+		std::string line;
+		while (std::getline(std::cin, line))
+		{
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line == "ACK") break;
+		}
+	}
+
+	// One line, since the reply is line based
+	std::string LastError(const char* fallback)
+	{
+		std::string error;
+		try
+		{
+			gmsh::logger::getLastError(error);
+		}
+		catch (...)
+		{
+		}
+
+		if (error.empty()) error = fallback;
+		for (char& c : error)
+			if (c == '\n' || c == '\r') c = ' ';
+
+		return error;
+	}
+}
+
+int main()
+{
+	gmsh::initialize();
+
+	// Standard output carries the protocol
+	gmsh::option::setNumber("General.Terminal", 0);
+
+	int sequence = 0;
+	std::string line;
+	while (std::getline(std::cin, line))
+	{
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line == "QUIT") break;
+		if (line.rfind("JOB", 0) != 0) continue;
+
+		try
+		{
+			Job job;
+			if (!ReadJob(line, job)) break;
+
+			RunJob(job, ++sequence);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "ERROR " << LastError(e.what()) << std::endl;
+		}
+		catch (...)
+		{
+			std::cout << "ERROR " << LastError("gmsh failed.") << std::endl;
+		}
+	}
+
+	gmsh::finalize();
+	return 0;
+}